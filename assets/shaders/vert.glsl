@@ -1,25 +1,29 @@
-
 #version 450
 
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV;
 layout(location = 3) in vec3 inColor;
+layout(location = 4) in ivec3 inChunk; // per instance, (x, 0, z)
 
 layout(location = 0) out vec3 fragNormal;
 layout(location = 1) out vec2 fragUV;
 layout(location = 2) out vec3 fragColor;
 
-layout(set = 0, binding = 0) uniform UBO {
+// Matches CameraUniforms. viewProj is relative to the camera position,
+// which is split into its chunk and the offset from that chunk's origin.
+layout(set = 0, binding = 0) uniform Camera {
     mat4 viewProj;
-} ubo;
-
-layout(push_constant) uniform Push {
-    mat4 model;
-} push;
+    ivec4 chunk;
+    vec4 offset;
+    ivec4 chunkDim;
+} cam;
 
 void main() {
-    gl_Position = ubo.viewProj * push.model * vec4(inPos, 1.0);
+    // Integer subtraction first: exact at any distance from the origin.
+    ivec3 d = (inChunk - cam.chunk.xyz) * cam.chunkDim.xyz;
+    vec3 rel = vec3(d) + (inPos - cam.offset.xyz);
+    gl_Position = cam.viewProj * vec4(rel, 1.0);
     fragNormal = inNormal;
     fragUV = inUV;
     fragColor = inColor;
@@ -1,26 +1,66 @@
 #pragma once
 
+#include "engine/core/LaunchOptions.hpp"
 #include "engine/platform/InputManager.hpp"
 #include "engine/platform/RendererContext.hpp"
 #include "engine/platform/WindowManager.hpp"
+#include "engine/render/CameraPath.hpp"
+#include "engine/render/Mesh.hpp"
+#include "engine/utils/FrameLimiter.hpp"
 #include "engine/utils/ThreadPool.hpp"
 #include "engine/world/ChunkManager.hpp"
 #include "engine/world/ChunkRenderSystem.hpp"
+#include "engine/world/FarTerrain.hpp"
+#include <functional>
+#include <memory>
+#include <string>
 
 class Application {
   public:
-    Application();
+    explicit Application(const LaunchOptions &options);
     ~Application();
     void Run();
 
   private:
     void mainLoop();
+    /// Plays the --camera-path script at a fixed timestep and prints a
+    /// frame time and pipeline statistics report.
+    void runBenchmark();
+    /// Renders frames until no chunk or far tile work is outstanding
+    /// around the camera. Returns false on SETTLE_TIMEOUT. `onFrameWaited`
+    /// runs after every waitForFrame(), while the retired frame's
+    /// statistics are still readable.
+    bool settleStreaming(const std::function<void()> &onFrameWaited = {});
+    void pollWindow();
+    /// Streams the world and records and submits one frame. Returns the
+    /// number of meshes handed to the upload thread.
+    size_t tick(float dt);
+    void buildRenderGraph();
+    void recordScene(VkCommandBuffer cmd);
+    GLFWwindow *window() const;
 
-    WindowManager windowManager_;
+    // Null when headless.
+    std::unique_ptr<WindowManager> windowManager_;
     engine::utils::ThreadPool threadPool_;
     engine::world::ChunkManager chunkManager_;
+    engine::world::FarTerrain farTerrain_;
     engine::world::ChunkRenderSystem chunkRenderer_;
     RendererContext rendererContext_;
-    InputManager inputManager_;
+    std::unique_ptr<InputManager> inputManager_;
     engine::utils::ThreadPool uploadPool_;
+    // Kept apart from threadPool_ so recording never queues behind meshing.
+    engine::utils::ThreadPool recordPool_;
+    engine::utils::FrameLimiter frameLimiter_;
+    // Meshes replaced in the scene, kept until no frame in flight draws
+    // them.
+    MeshRetireQueue retiredMeshes_;
+    bool imgui_;
+    std::string cameraPath_;
+    std::string reportPath_;
+    std::string recordPathFile_;
+    bool lockstep_;
+    // Interactive camera recording for --record-path.
+    std::unique_ptr<engine::render::CameraPath> recordPath_;
+    double recordStart_ = 0.0;
+    double nextRecordSample_ = 0.0;
 };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Per-frame measurements from a scripted benchmark run.
+class BenchmarkReport {
+  public:
+    struct Frame {
+        double frameMs; // fence wait plus cpuMs
+        double cpuMs;   // streaming, recording and submit
+        double gpuMs;   // command buffer execution, from timestamps
+        uint64_t submittedTris;
+        uint64_t rasterizedTris;
+        uint64_t fragments;
+        size_t chunksMeshed;
+        size_t chunksInFlight;
+        size_t chunkUploads; // meshes handed to the upload thread
+    };
+
+    void add(const Frame &frame) { frames_.push_back(frame); }
+    size_t size() const { return frames_.size(); }
+
+    /// Frame count, mean fps, frame/CPU/GPU time percentiles and mean
+    /// statistics.
+    void printSummary(std::ostream &out) const;
+    void writeCsv(const std::string &path) const;
+
+  private:
+    std::vector<Frame> frames_;
+};
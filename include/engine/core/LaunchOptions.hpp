@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vulkan/vulkan.h>
+
+/// Per-deployment settings taken from the command line; defaults come from
+/// engine/world/Config.hpp.
+struct LaunchOptions {
+    /// Frames the CPU may record ahead of the GPU (1-4). 1 minimises
+    /// latency, 3 maximises throughput.
+    size_t framesInFlight;
+    /// Preferred present mode; falls back to FIFO when unsupported.
+    VkPresentModeKHR presentMode;
+    /// Main loop frame cap; 0 runs uncapped.
+    double targetFps;
+    /// Window size, or render target size when headless.
+    uint32_t width;
+    uint32_t height;
+    /// Render offscreen with no window or surface (e.g. on lavapipe).
+    /// Requires a camera path.
+    bool headless;
+    /// Camera script to benchmark; empty runs interactively.
+    std::string cameraPath;
+    /// Optional per-frame CSV written after a benchmark.
+    std::string reportPath;
+    /// Settle chunk streaming before every benchmark frame, so each frame
+    /// renders identical content regardless of worker timing.
+    bool lockstep;
+    /// Interactive runs write the flown camera path here on exit.
+    std::string recordPath;
+    /// Chunks for the CPU meshing benchmark; non-zero runs it instead of
+    /// the engine.
+    size_t benchMeshing;
+
+    static LaunchOptions parse(int argc, char **argv);
+};
+
+/// Command-line spelling of a present mode, as accepted by --present-mode.
+const char *presentModeName(VkPresentModeKHR mode);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+/// CPU-only benchmark of terrain generation and greedy meshing for every
+/// VoxelVolume layout. Needs no window or GPU.
+class MeshingBenchmark {
+  public:
+    /// Generates and meshes the same `chunks` chunks once per layout and
+    /// prints generation time and meshing time per sweep axis.
+    static void Run(size_t chunks, std::ostream &out);
+};
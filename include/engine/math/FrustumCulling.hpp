@@ -1,17 +1,43 @@
-
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <vector>
 
 namespace engine::math {
 
+/// Box bounds stored structure-of-arrays, one array per component, so the
+/// batch test can load four or eight boxes per instruction.
+struct AabbSoA {
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    void clear();
+    void reserve(size_t count);
+    void push(const glm::vec3 &mn, const glm::vec3 &mx);
+    size_t size() const { return minX.size(); }
+};
+
 /// A simple view‑frustum built from a viewProj matrix.
 /// Planes are in the form (a,b,c,d) where ax+by+cz+d=0.
+/// Build it from Camera::relativeViewProjection() and test boxes given
+/// relative to the camera (see world::relativeOrigin), so plane distances
+/// stay small and exact however far the camera is from the world origin.
 class FrustumCuller {
   public:
     void update(const glm::mat4 &viewProj);
     bool isBoxVisible(const glm::vec3 &mn, const glm::vec3 &mx) const;
 
+    /// Tests boxes [first, last) with SSE, or AVX where the CPU has it, and
+    /// sets bit i % 64 of mask[i / 64] for each box that may be visible.
+    /// `first` must be a multiple of 64 so disjoint ranges write disjoint
+    /// words; the culler is read-only, so workers can cull ranges in
+    /// parallel once update() has run.
+    void cullBoxes(const AabbSoA &boxes, size_t first, size_t last,
+                   uint64_t *mask) const;
+    /// Culls every box, resizing `mask` to one bit per box.
+    void cullBoxes(const AabbSoA &boxes, std::vector<uint64_t> &mask) const;
+
   private:
     glm::vec4 planes[6];
 
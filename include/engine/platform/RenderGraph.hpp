@@ -1,30 +1,152 @@
 #pragma once
 
-#include <glm/mat4x4.hpp>
+#include "externals/vk_mem_alloc.h"
+#include <functional>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
-class RenderResources;
-class RenderCommandManager;
-
+/// Declarative frame graph. Passes declare which resources they read and
+/// write; compile() culls passes that do not contribute to an imported
+/// resource, computes transient lifetimes and aliases transient images whose
+/// lifetimes do not overlap into shared memory. execute() records every
+/// pass in declaration order (always a valid topological order, since a pass
+/// can only consume what earlier passes produced) with the barriers derived
+/// from the declared accesses.
 class RenderGraph {
   public:
-    void beginFrame(RenderResources &resources,
-                    RenderCommandManager &commandManager, size_t frameIndex,
-                    uint32_t imageIndex, // <- add this
-                    const glm::mat4 &viewProj, VkImage swapchainImage,
-                    VkImageLayout currentLayout);
+    using ResourceId = uint32_t;
+
+    enum class PassType { Graphics, Compute };
+
+    enum class Access {
+        ColorAttachment,
+        DepthAttachment,
+        Sampled,
+        Storage,
+        TransferSrc,
+        TransferDst,
+        Indirect,
+        Vertex,
+    };
+
+    enum class LoadOp { Load, Clear, DontCare };
+
+    /// Transient image; sized to the graph extent times `scale`.
+    struct ImageDesc {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        float scale = 1.0f;
+    };
+
+    class PassBuilder {
+      public:
+        void read(ResourceId id, Access access);
+        void write(ResourceId id, Access access,
+                   LoadOp load = LoadOp::Load, VkClearValue clear = {});
+        /// The pass only calls vkCmdExecuteCommands inside its rendering
+        /// scope; secondaries must set their own viewport and scissor.
+        void useSecondaryCommandBuffers();
+
+      private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph &graph, size_t pass)
+            : graph_(graph), pass_(pass) {}
+        RenderGraph &graph_;
+        size_t pass_;
+    };
+
+    using SetupFn = std::function<void(PassBuilder &)>;
+    using ExecuteFn = std::function<void(VkCommandBuffer)>;
+
+    void init(VkDevice device, VmaAllocator allocator);
+    void cleanup();
 
-    void endFrame();
+    /// Externally owned image. Its contents are treated as undefined at the
+    /// start of each frame and it is left in `finalLayout` at the end.
+    ResourceId importImage(const std::string &name, VkImageAspectFlags aspect,
+                           VkImageLayout finalLayout);
+    ResourceId importBuffer(const std::string &name);
+    ResourceId createImage(const std::string &name, const ImageDesc &desc);
 
-    void reset() { finalLayout_ = VK_IMAGE_LAYOUT_UNDEFINED; }
-    VkCommandBuffer &getCurrentCommandBuffer() { return commandBuffer_; }
+    /// Rebinds an imported resource; called per frame for the swapchain.
+    void setImportedImage(ResourceId id, VkImage image, VkImageView view);
+    void setImportedBuffer(ResourceId id, VkBuffer buffer);
 
-    // For layout tracking
-    VkImageLayout getFinalLayout() const { return finalLayout_; }
+    void addPass(const std::string &name, PassType type, const SetupFn &setup,
+                 ExecuteFn execute);
+
+    /// Sets the extent transients and attachments are sized against.
+    void resize(VkExtent2D extent);
+    void compile();
+    void execute(VkCommandBuffer cmd);
+
+    VkImageView getImageView(ResourceId id) const;
+    size_t transientBytes() const { return transientBytes_; }
+    size_t aliasedBytes() const { return aliasedBytes_; }
 
   private:
-    VkCommandBuffer commandBuffer_ = VK_NULL_HANDLE;
-    VkImage swapchainImage_ = VK_NULL_HANDLE;
-    VkImageLayout finalLayout_ = VK_IMAGE_LAYOUT_UNDEFINED;
+    struct AccessDecl {
+        ResourceId resource;
+        Access access;
+        bool write;
+        LoadOp load;
+        VkClearValue clear;
+    };
+
+    struct Pass {
+        std::string name;
+        PassType type;
+        ExecuteFn execute;
+        std::vector<AccessDecl> accesses;
+        bool secondary = false;
+        bool culled = false;
+    };
+
+    struct State {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        VkAccessFlags2 access = VK_ACCESS_2_MEMORY_WRITE_BIT;
+        bool write = true;
+    };
+
+    struct Resource {
+        std::string name;
+        bool imported = false;
+        bool isBuffer = false;
+        ImageDesc desc;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkExtent2D extent{};
+        int firstPass = -1;
+        int lastPass = -1;
+        int slot = -1;
+        State state;
+    };
+
+    /// Memory block shared by transient images with disjoint lifetimes.
+    struct AliasSlot {
+        VkMemoryRequirements reqs{};
+        int lastPass = -1;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+
+    void destroyTransients();
+    void transition(Resource &res, const Pass &pass, const AccessDecl &decl,
+                    std::vector<VkImageMemoryBarrier2> &images,
+                    std::vector<VkBufferMemoryBarrier2> &buffers);
+    void recordRendering(VkCommandBuffer cmd, const Pass &pass);
+
+    VkDevice device_ = VK_NULL_HANDLE;
+    VmaAllocator allocator_ = VK_NULL_HANDLE;
+    VkExtent2D extent_{};
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+    std::vector<AliasSlot> slots_;
+    bool compiled_ = false;
+    size_t transientBytes_ = 0;
+    size_t aliasedBytes_ = 0;
 };
@@ -2,39 +2,59 @@
 
 #pragma once
 
-#include "engine/platform/DepthResources.hpp"
-#include "engine/platform/FramebufferManager.hpp"
-#include "engine/platform/RenderPassManager.hpp"
 #include "engine/platform/Swapchain.hpp"
 #include "engine/platform/UniformManager.hpp"
 #include "engine/platform/VulkanDevice.hpp"
+#include "engine/render/Camera.hpp"
 #include "engine/render/Pipeline.hpp"
+#include "engine/render/PipelineCache.hpp"
+
+/// Camera block at set 0, binding 0; mirrors `Camera` in vert.glsl. The
+/// camera position is split into its chunk and the offset within it so the
+/// shader can form camera-relative positions without float error.
+struct CameraUniforms {
+    glm::mat4 viewProj; // camera-relative
+    glm::ivec4 chunk;   // (x, 0, z)
+    glm::vec4 offset;
+    glm::ivec4 chunkDim;
+};
 
 class RenderResources {
   public:
-    void init(VulkanDevice *device, Swapchain *swapchain);
+    void init(VulkanDevice *device, Swapchain *swapchain,
+              size_t framesInFlight);
     void recreate();
     void cleanup();
 
     const engine::render::Pipeline &getPipeline() const;
-    VkRenderPass getRenderPass() const;
-    const std::vector<VkFramebuffer> &getFramebuffers() const;
+    VkFormat getColorFormat() const { return colorFormat_; }
+    VkFormat getDepthFormat() const { return VK_FORMAT_D32_SFLOAT; }
+
+    /// Binds the voxel pipeline and this frame's camera block.
+    void bindPipeline(VkCommandBuffer cmd) const;
     const std::vector<VkDescriptorSet> &getDescriptorSets() const;
     VkDescriptorSetLayout getDescriptorSetLayout() const;
 
     VmaAllocator getAllocator() const;
 
     Swapchain *getSwapchain() const;
-    void updateUniforms(size_t frameIndex, const glm::mat4 &viewProj);
+    /// Recycles `frameIndex`'s uniform ring region and writes the camera
+    /// block into it. Call once per frame after its fence has signalled.
+    void updateUniforms(size_t frameIndex,
+                        const engine::render::Camera &camera);
+    /// Per-frame constants beyond the camera are pushed here.
+    UniformManager &uniforms() { return uniforms_; }
 
   private:
+    void createPipeline();
+
     VulkanDevice *device_ = nullptr;
     Swapchain *swapchain_ = nullptr;
     VmaAllocator allocator_ = VK_NULL_HANDLE;
 
-    DepthResources depth_;
-    RenderPassManager renderPass_;
     UniformManager uniforms_;
-    FramebufferManager framebuffers_;
+    uint32_t cameraOffset_ = 0;
     engine::render::Pipeline pipeline_;
+    engine::render::PipelineCache pipelineCache_;
+    VkFormat colorFormat_ = VK_FORMAT_UNDEFINED;
 };
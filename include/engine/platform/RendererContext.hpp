@@ -6,6 +6,7 @@
 #include "engine/platform/RenderCommandManager.hpp"
 #include "engine/platform/RenderGraph.hpp"
 #include "engine/platform/RenderResources.hpp"
+#include "engine/platform/SecondaryCommandManager.hpp"
 #include "engine/platform/Swapchain.hpp"
 #include "engine/platform/VulkanDevice.hpp"
 #include "engine/render/Camera.hpp"
@@ -16,22 +17,64 @@
 
 class RendererContext {
   public:
-    explicit RendererContext(GLFWwindow *window);
+    /// With a null `window` the context is headless: it renders into
+    /// offscreen images of `extent`, presents nothing and never touches the
+    /// window system. Otherwise `extent` only seeds the camera aspect.
+    RendererContext(GLFWwindow *window, VkExtent2D extent,
+                    size_t framesInFlight, VkPresentModeKHR presentMode);
     ~RendererContext();
-    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT;
+    /// Blocks until the GPU has released this frame's slot and collects
+    /// its query results. Call right before sampling input so the input is
+    /// as fresh as possible when recording starts; beginFrame() calls it if
+    /// it has not been called yet.
+    void waitForFrame();
     void beginFrame();
+
+    struct FrameStats {
+        uint64_t frame = 0; // frameNumber() the frame was begun with
+        double gpuMs = 0.0; // 0 if the queue has no timestamps
+        uint64_t submittedTris = 0;
+        uint64_t rasterizedTris = 0;
+        uint64_t fragments = 0;
+    };
+    /// Statistics of the frame that last used the current slot, collected
+    /// by waitForFrame(); zero until every slot has been used once.
+    FrameStats retiredFrameStats() const;
+    /// Serial of the next frame to be begun.
+    uint64_t frameNumber() const { return framesSubmitted_; }
     void endFrame();
     void recreateSwapchain();
     void cleanup();
     size_t getFrameIndex() const { return currentFrame_; }
+    size_t framesInFlight() const { return framesInFlight_; }
     engine::render::Camera &camera() { return cam_; }
 
-    VkCommandBuffer &getCurrentCommandBuffer() {
-        return renderGraph_.getCurrentCommandBuffer();
+    VkCommandBuffer getCurrentCommandBuffer() const {
+        return commandManager_.get(currentFrame_);
     }
     uint32_t getCurrentImageIndex() const { return currentImageIndex_; }
 
+    /// True when scene draws are recorded into secondaries on worker
+    /// threads. Needs inherited queries, since the statistics queries stay
+    /// active around the whole frame.
+    bool parallelRecording() const;
+    size_t recordThreadCount() const {
+        return secondaryCommands_.threadCount();
+    }
+    /// Begins `thread`'s secondary for this frame, inheriting the scene
+    /// attachment formats and active queries. Safe to call concurrently
+    /// for distinct threads.
+    VkCommandBuffer beginSecondary(size_t thread);
+
     RenderResources &getRenderResources() { return renderResources_; }
+    RenderGraph &getRenderGraph() { return renderGraph_; }
+    /// Swapchain image acquired for the current frame.
+    RenderGraph::ResourceId backbuffer() const { return backbuffer_; }
+    RenderGraph::ResourceId depthTarget() const { return depthTarget_; }
     VulkanDevice *getDevice() const { return device_.get(); }
     Swapchain *getSwapchain() const { return swapchain_.get(); }
 
@@ -40,18 +83,25 @@ class RendererContext {
 
     VkQueryPool pipelineStatsQueryPool_{VK_NULL_HANDLE};
     VkQueryPool occlusionQueryPool_{VK_NULL_HANDLE};
-    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> statsSubmitted_{};
-    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> statsRasterized_{};
-    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> statsSamples_{};
-    bool firstFrame_ = true;
 
   private:
-    void init(GLFWwindow *window);
+    void init(GLFWwindow *window, VkExtent2D extent);
+    void createQueryPools();
+
+    bool frameWaited_ = false;
+    uint64_t framesSubmitted_ = 0;
+    std::vector<FrameStats> frameStats_; // per slot
+
+    // Two timestamps per slot bracketing the frame's command buffer.
+    VkQueryPool timestampQueryPool_{VK_NULL_HANDLE};
+    float timestampPeriod_ = 0.0f; // ns per tick, 0 if unsupported
 
+    size_t framesInFlight_;
     size_t currentFrame_ = 0;
     uint32_t currentImageIndex_ = 0;
 
     std::unique_ptr<VulkanDevice> device_;
+    VkPresentModeKHR presentMode_;
     std::unique_ptr<Swapchain> swapchain_;
     VmaAllocator allocator_{VK_NULL_HANDLE};
 
@@ -59,7 +109,10 @@ class RendererContext {
     FrameSync frameSync_;
 
     RenderCommandManager commandManager_;
+    SecondaryCommandManager secondaryCommands_;
     RenderGraph renderGraph_;
+    RenderGraph::ResourceId backbuffer_ = 0;
+    RenderGraph::ResourceId depthTarget_ = 0;
     RenderResources renderResources_;
 
     VkDescriptorPool imguiDescriptorPool_{VK_NULL_HANDLE};
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+
+/// Secondary command buffers for parallel recording. Each recording thread
+/// owns one command pool per frame in flight, so pools are never shared
+/// between threads and a frame's pools can be reset wholesale once its
+/// fence has signalled.
+class SecondaryCommandManager {
+  public:
+    void init(VkDevice device, uint32_t queueFamilyIndex,
+              size_t framesInFlight, size_t threadCount);
+    void cleanup(VkDevice device);
+
+    /// Recycles every buffer of `frameIndex`; its last submission must have
+    /// completed.
+    void reset(VkDevice device, size_t frameIndex);
+
+    VkCommandBuffer get(size_t frameIndex, size_t thread) const;
+    size_t threadCount() const { return threadCount_; }
+
+  private:
+    size_t threadCount_ = 0;
+    std::vector<VkCommandPool> pools_;            // [frame * threads + thread]
+    std::vector<VkCommandBuffer> commandBuffers_; // same indexing
+};
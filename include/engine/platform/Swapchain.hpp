@@ -8,7 +8,14 @@
 
 class Swapchain {
   public:
-    Swapchain(VulkanDevice *device, VkSurfaceKHR surface, GLFWwindow *window);
+    /// Requests enough images that `framesInFlight` frames can be queued
+    /// without waiting on the presentation engine. `presentMode` is used
+    /// when the surface supports it, FIFO (always available) otherwise.
+    Swapchain(VulkanDevice *device, VkSurfaceKHR surface, GLFWwindow *window,
+              size_t framesInFlight, VkPresentModeKHR presentMode);
+    /// Offscreen stand-in for headless rendering: one image per frame in
+    /// flight, left in TRANSFER_SRC layout for readback, never presented.
+    Swapchain(VulkanDevice *device, VkExtent2D extent, size_t framesInFlight);
     ~Swapchain();
 
     void recreate();
@@ -19,19 +26,28 @@ class Swapchain {
         return imageViews_;
     }
     VkFormat getImageFormat() const { return imageFormat_; }
+    uint32_t getMinImageCount() const { return minImageCount_; }
+    VkPresentModeKHR getPresentMode() const { return presentMode_; }
+    bool isOffscreen() const { return surface_ == VK_NULL_HANDLE; }
 
     const std::vector<VkImage> &getImages() const { return images_; }
 
   private:
     VulkanDevice *device_;
-    VkSurfaceKHR surface_;
+    VkSurfaceKHR surface_ = VK_NULL_HANDLE;
     VkExtent2D extent_{};
     VkSwapchainKHR swapchain_{VK_NULL_HANDLE};
     std::vector<VkImage> images_;
     std::vector<VkImageView> imageViews_;
     VkFormat imageFormat_{};
-    GLFWwindow *window_;
+    GLFWwindow *window_ = nullptr;
+    std::vector<VmaAllocation> allocations_;
+    size_t framesInFlight_;
+    uint32_t minImageCount_ = 0;
+    VkPresentModeKHR requestedPresentMode_;
+    VkPresentModeKHR presentMode_ = VK_PRESENT_MODE_FIFO_KHR;
 
     void create();
+    void createOffscreen();
     void createImageViews();
 };
@@ -1,17 +1,42 @@
-
 #pragma once
 #include "engine/platform/DescriptorManager.hpp"
 #include "externals/vk_mem_alloc.h"
+#include <atomic>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 
+/// Persistently mapped ring for per-frame GPU constants. Every frame in
+/// flight owns a fixed region of one host-coherent buffer; allocate()
+/// bump-allocates from the current frame's region, aligned to
+/// minUniformBufferOffsetAlignment, and returns a write pointer plus the
+/// dynamic offset to bind. beginFrame() recycles a region once its fence
+/// has signalled, so per-frame updates never map, unmap or flush.
+///
+/// The descriptor set exposes the buffer as a dynamic uniform buffer at
+/// binding 0 with a range of `bindingRange` bytes (the camera block).
 class UniformManager {
   public:
-    void init(VkDevice device, VmaAllocator allocator, size_t frameCount);
-    void update(VmaAllocator allocator, size_t frameIndex,
-                const glm::mat4 &mat);
+    struct Allocation {
+        void *data;
+        uint32_t offset; // dynamic offset into buffer()
+    };
+
+    void init(VkDevice device, VkPhysicalDevice physDevice,
+              VmaAllocator allocator, size_t frameCount,
+              VkDeviceSize bytesPerFrame, VkDeviceSize bindingRange);
     void cleanup(VkDevice device, VmaAllocator allocator);
 
+    /// Starts handing out `frameIndex`'s region from its beginning.
+    void beginFrame(size_t frameIndex);
+    /// Thread-safe. Throws when the frame's region is exhausted.
+    Allocation allocate(VkDeviceSize size);
+    template <typename T> uint32_t push(const T &value) {
+        Allocation a = allocate(sizeof(T));
+        std::memcpy(a.data, &value, sizeof(T));
+        return a.offset;
+    }
+
     VkBuffer buffer() const { return buffer_; }
     VkDescriptorSetLayout layout() const { return descriptorMgr_.getLayout(); }
     const std::vector<VkDescriptorSet> &sets() const {
@@ -22,4 +47,9 @@ class UniformManager {
     DescriptorManager descriptorMgr_;
     VkBuffer buffer_ = VK_NULL_HANDLE;
     VmaAllocation allocation_ = VK_NULL_HANDLE;
+    char *mapped_ = nullptr;
+    VkDeviceSize alignment_ = 1;
+    VkDeviceSize frameBytes_ = 0;
+    VkDeviceSize frameBase_ = 0;
+    std::atomic<VkDeviceSize> head_{0}; // relative to frameBase_
 };
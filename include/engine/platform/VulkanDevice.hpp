@@ -7,6 +7,9 @@
 
 class VulkanDevice {
   public:
+    /// A null `window` creates a headless device: no surface, no swapchain
+    /// extension and any graphics queue, so software implementations such
+    /// as lavapipe qualify.
     explicit VulkanDevice(GLFWwindow *window);
     ~VulkanDevice();
 
@@ -20,12 +23,17 @@ class VulkanDevice {
     VkDevice getDevice() const { return device_; }
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice_; }
     VkSurfaceKHR getSurface() const { return surface_; }
+    bool isHeadless() const { return headless_; }
     VkQueue getGraphicsQueue() const { return graphicsQueue_; }
     VkCommandPool getCommandPool() const { return commandPool_; }
     VmaAllocator getAllocator() const { return allocator_; }
     uint32_t getGraphicsQueueFamilyIndex() const {
         return graphicsQueueFamilyIndex_;
     }
+    /// Optional core features that were actually enabled on the device.
+    const VkPhysicalDeviceFeatures &getEnabledFeatures() const {
+        return enabledFeatures_;
+    }
 
   private:
     // Vulkan handles
@@ -38,6 +46,8 @@ class VulkanDevice {
     VmaAllocator allocator_{VK_NULL_HANDLE};
 
     uint32_t graphicsQueueFamilyIndex_{};
+    bool headless_ = false;
+    VkPhysicalDeviceFeatures enabledFeatures_{};
 
 #ifdef ENABLE_VALIDATION_LAYERS
     VkDebugUtilsMessengerEXT debugMessenger_{VK_NULL_HANDLE};
@@ -9,7 +9,7 @@ class Camera {
   public:
     Camera(float fovY, float aspect, float nearPlane, float farPlane);
 
-    void setPosition(const glm::vec3 &pos) { position = pos; }
+    void setPosition(const glm::dvec3 &pos) { position = pos; }
     void setAspect(float a) { aspect = a; }
     void setRotation(float newYaw, float newPitch) {
         yaw = newYaw;
@@ -18,16 +18,9 @@ class Camera {
         pitch = glm::clamp(newPitch, -limit, +limit);
     }
 
-    const glm::vec3 &getPosition() const { return position; }
-
-    glm::mat4 viewMatrix() const {
-        glm::vec3 front;
-        front.x = cos(pitch) * cos(yaw);
-        front.y = sin(pitch);
-        front.z = cos(pitch) * sin(yaw);
-        return glm::lookAt(position, position + glm::normalize(front),
-                           glm::vec3(0, 1, 0));
-    }
+    /// World position in double precision. There is no absolute view
+    /// matrix: everything sent to the GPU is relative to this point.
+    const glm::dvec3 &getPosition() const { return position; }
 
     glm::mat4 projectionMatrix() const {
         glm::mat4 proj = glm::perspectiveZO(fovY, aspect, nearPlane, farPlane);
@@ -35,8 +28,11 @@ class Camera {
         return proj;
     }
 
-    glm::mat4 viewProjection() const {
-        return projectionMatrix() * viewMatrix();
+    /// View-projection with the camera at the origin, for geometry already
+    /// expressed relative to the camera position.
+    glm::mat4 relativeViewProjection() const {
+        return projectionMatrix() *
+               glm::lookAt(glm::vec3(0.0f), front(), glm::vec3(0, 1, 0));
     }
 
     float getYaw() const { return yaw; }
@@ -50,7 +46,7 @@ class Camera {
     }
 
   private:
-    glm::vec3 position{0.0f, 0.0f, 0.0f};
+    glm::dvec3 position{0.0, 0.0, 0.0};
     float yaw = glm::radians(-90.0f);
     float pitch = 0.0f;
     float fovY;
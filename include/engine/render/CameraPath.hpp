@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace engine::render {
+
+class Camera;
+
+/// Scripted camera motion for benchmarks. Text format, one keyframe per
+/// line, '#' starts a comment:
+///
+///     time_s  x y z  yaw_deg pitch_deg
+///
+/// Keyframe times must be strictly increasing. Position, yaw and pitch
+/// follow a Catmull-Rom spline through the keyframes, so sparse or recorded
+/// paths play back without velocity kinks. Yaw is not wrapped: a turn from
+/// 170 to -170 degrees goes the long way round.
+class CameraPath {
+  public:
+    struct Keyframe {
+        float time;
+        glm::dvec3 position;
+        float yaw;   // radians
+        float pitch; // radians
+    };
+
+    static CameraPath load(const std::string &path);
+    void save(const std::string &path) const;
+
+    /// Appends a keyframe; `key.time` must exceed the last keyframe's.
+    void addKeyframe(const Keyframe &key);
+    bool empty() const { return keys_.empty(); }
+    float duration() const;
+    /// Poses `camera` at time `t`, clamped to the path's extent.
+    void apply(float t, Camera &camera) const;
+
+  private:
+    std::vector<Keyframe> keys_;
+};
+
+} // namespace engine::render
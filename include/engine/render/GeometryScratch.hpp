@@ -0,0 +1,23 @@
+#pragma once
+
+#include "engine/render/Vertex.hpp"
+#include <cstdint>
+#include <vector>
+
+/// Vertex and index buffers that mesh builders fill before copying the
+/// result into a Mesh with Mesh::setGeometry(). Kept per thread, so once
+/// they have grown to the largest mesh a worker has built, building a mesh
+/// allocates only the finished Mesh.
+struct GeometryScratch {
+    std::vector<Vertex> verts;
+    std::vector<uint32_t> idxs;
+};
+
+/// The calling thread's scratch buffers, emptied but with their capacity
+/// kept. The next call on the same thread reuses them.
+inline GeometryScratch &threadGeometryScratch() {
+    thread_local GeometryScratch scratch;
+    scratch.verts.clear();
+    scratch.idxs.clear();
+    return scratch;
+}
@@ -4,30 +4,76 @@
 
 #include "engine/platform/VulkanDevice.hpp"
 #include "engine/render/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 class Mesh {
   public:
     Mesh() = default;
+    ~Mesh() { destroy(); }
+    Mesh(const Mesh &) = delete;
+    Mesh &operator=(const Mesh &) = delete;
 
-    void setVertices(std::vector<Vertex> &&v);
-    void setIndices(std::vector<uint32_t> &&i);
+    /// Copies geometry built in reusable scratch buffers into storage
+    /// sized exactly for it.
+    void setGeometry(std::span<const Vertex> vertices,
+                     std::span<const uint32_t> indices);
+    /// Chunk whose origin the vertices are relative to. Uploaded once,
+    /// behind the vertices, as a MeshInstance.
+    void setOrigin(const glm::ivec2 &chunk) { origin_ = chunk; }
 
     // upload to GPU
     void uploadToGPU(VulkanDevice *device);
+    /// Frees the GPU buffers. No frame still in flight may draw the mesh;
+    /// see MeshRetireQueue.
+    void destroy();
 
     // getters for binding
     VkBuffer vertexBuffer() const { return vbo_; }
+    /// Offset of the MeshInstance record within vertexBuffer().
+    VkDeviceSize instanceOffset() const { return instanceOffset_; }
+    const glm::ivec2 &origin() const { return origin_; }
     VkBuffer indexBuffer() const { return ibo_; }
     size_t indexCount() const { return indices_count_; }
 
   private:
-    std::vector<Vertex> vertices_;
+    /// Vertices followed by room for the MeshInstance: the vertex buffer
+    /// exactly as uploaded.
+    std::vector<std::byte> vertexData_;
     std::vector<uint32_t> indices_;
     // Vulkan handles
+    VkDevice device_ = VK_NULL_HANDLE; // set once uploaded
     VkBuffer vbo_ = VK_NULL_HANDLE;
     VkDeviceMemory vboMem_ = VK_NULL_HANDLE;
     VkBuffer ibo_ = VK_NULL_HANDLE;
     VkDeviceMemory iboMem_ = VK_NULL_HANDLE;
     size_t indices_count_ = 0;
+    glm::ivec2 origin_{0};
+    VkDeviceSize instanceOffset_ = 0;
+};
+
+/// Meshes taken out of the scene while earlier frames may still draw them.
+/// Each is destroyed once every frame begun before it was retired has
+/// finished on the GPU. Main thread only.
+class MeshRetireQueue {
+  public:
+    /// Destroys the meshes no frame in flight can reference. Call once per
+    /// frame after RendererContext::waitForFrame(), with the serial of the
+    /// frame about to be begun.
+    void advance(uint64_t frame, size_t framesInFlight);
+    void retire(std::unique_ptr<Mesh> mesh);
+    /// Destroys every mesh at once; the device must be idle.
+    void clear() { meshes_.clear(); }
+    size_t size() const { return meshes_.size(); }
+
+  private:
+    uint64_t frame_ = 0;
+    size_t framesInFlight_ = 1;
+    // Frame serial from which each mesh is safe to destroy, ascending.
+    std::deque<std::pair<uint64_t, std::unique_ptr<Mesh>>> meshes_;
 };
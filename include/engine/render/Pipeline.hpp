@@ -10,9 +10,12 @@ struct Pipeline {
     VkPipeline pipeline{VK_NULL_HANDLE};
     VkPipelineLayout layout{VK_NULL_HANDLE};
 
-    void init(VkDevice device, VkRenderPass renderPass,
+    /// Built for dynamic rendering: only the attachment formats are baked
+    /// in, so the pipeline survives swapchain resizes.
+    void init(VkDevice device, VkFormat colorFormat, VkFormat depthFormat,
               VkDescriptorSetLayout dsl, const std::string &vertSPV,
-              const std::string &fragSPV);
+              const std::string &fragSPV,
+              VkPipelineCache cache = VK_NULL_HANDLE);
 
     void cleanup(VkDevice device);
 };
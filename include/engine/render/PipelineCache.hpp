@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vulkan/vulkan.h>
+
+namespace engine::render {
+
+/// VkPipelineCache persisted between runs. The file carries its own header
+/// (vendor, device, driver version and pipelineCacheUUID) and is discarded
+/// when any of them differ from the current device.
+class PipelineCache {
+  public:
+    void init(VkDevice device, VkPhysicalDevice physDevice,
+              const std::string &path);
+    /// Writes the cache back to disk, then destroys it.
+    void cleanup(VkDevice device);
+
+    VkPipelineCache get() const { return cache_; }
+
+  private:
+    void save(VkDevice device) const;
+
+    VkPipelineCache cache_{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties props_{};
+    std::string path_;
+};
+
+} // namespace engine::render
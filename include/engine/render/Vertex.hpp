@@ -2,6 +2,7 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 struct Vertex {
     glm::vec3 pos;
@@ -9,3 +10,11 @@ struct Vertex {
     glm::vec2 uv;
     glm::vec3 color;
 };
+
+/// Per-draw record at vertex binding 1 (instance rate): the chunk the
+/// mesh's vertices are relative to, as (x, 0, z). The shader subtracts the
+/// camera's chunk before converting to float, so precision does not degrade
+/// with distance from the world origin.
+struct MeshInstance {
+    glm::ivec4 chunk; // w unused
+};
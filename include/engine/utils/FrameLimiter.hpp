@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+
+namespace engine::utils {
+
+/// Paces the main loop to a fixed frame rate. Sleeps for most of the wait
+/// and spins the final stretch, since OS sleeps overshoot by up to a
+/// scheduler tick.
+class FrameLimiter {
+  public:
+    /// `fps` <= 0 disables the limiter.
+    explicit FrameLimiter(double fps = 0.0);
+
+    void setTarget(double fps);
+    double target() const { return fps_; }
+
+    /// Blocks until the next frame slot. A frame that overran its slot
+    /// starts the next one immediately rather than trying to catch up.
+    void wait();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    double fps_ = 0.0;
+    Clock::duration period_{};
+    Clock::time_point next_{};
+};
+
+} // namespace engine::utils
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace engine::voxel {
+
+/// Storage-order policies for BasicVoxelVolume. Each maps a logical
+/// (x, y, z) to an index over the extent padded to whole tiles. TILE is the
+/// edge of the cubes the layout keeps contiguous (0: the whole volume), so
+/// loops can walk tile by tile; x varies fastest, then y, then z, both
+/// across tiles and within them.
+
+/// Plain x-fastest order: (z * extent.y + y) * extent.x + x.
+struct LinearLayout {
+    static constexpr int TILE = 0;
+    static constexpr const char *NAME = "linear";
+
+    static glm::ivec3 padded(const glm::ivec3 &extent) { return extent; }
+    static size_t index(const glm::ivec3 &padded, int x, int y, int z) {
+        return (size_t(z) * padded.y + y) * padded.x + x;
+    }
+};
+
+/// N^3 bricks in linear order, linear order inside each brick.
+template <int N> struct BrickLayout {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "brick edge must be 2^k");
+    static constexpr int TILE = N;
+    static constexpr int SHIFT = std::countr_zero(unsigned(N));
+    static constexpr const char *NAME = "brick";
+
+    static glm::ivec3 padded(const glm::ivec3 &extent) {
+        return (extent + glm::ivec3(N - 1)) / N * N;
+    }
+    static size_t index(const glm::ivec3 &padded, int x, int y, int z) {
+        const size_t brick =
+            (size_t(z >> SHIFT) * size_t(padded.y >> SHIFT) + (y >> SHIFT)) *
+                size_t(padded.x >> SHIFT) +
+            (x >> SHIFT);
+        const size_t inner =
+            (size_t(z & (N - 1)) * N + (y & (N - 1))) * N + (x & (N - 1));
+        return brick * (N * N * N) + inner;
+    }
+};
+
+/// The brick size the engine instantiates; a plain name for -DVOXEL_LAYOUT.
+using Brick4Layout = BrickLayout<4>;
+
+/// Morton (Z-order) inside 8^3 tiles, tiles in linear order. Full-volume
+/// Morton would pad a 16x256x16 chunk to 256^3; tiles keep the padding to
+/// the downsampled LOD volumes only.
+struct MortonLayout {
+    static constexpr int TILE = 8;
+    static constexpr const char *NAME = "morton";
+
+    static glm::ivec3 padded(const glm::ivec3 &extent) {
+        return (extent + glm::ivec3(TILE - 1)) / TILE * TILE;
+    }
+    static size_t index(const glm::ivec3 &padded, int x, int y, int z) {
+        const size_t tile = (size_t(z >> 3) * size_t(padded.y >> 3) +
+                             (y >> 3)) *
+                                size_t(padded.x >> 3) +
+                            (x >> 3);
+        return tile * 512 + (spread(x & 7) | spread(y & 7) << 1 |
+                             spread(z & 7) << 2);
+    }
+
+  private:
+    /// abc -> a00b00c
+    static size_t spread(int v) {
+        return size_t((v & 1) | (v & 2) << 2 | (v & 4) << 4);
+    }
+};
+
+/// Calls f(a, b) for every cell of an `na` x `nb` grid, b as the outer
+/// axis, tile by tile for `Layout`. Visiting (a, b) of a volume this way
+/// touches storage in roughly ascending order when a is the faster axis.
+template <typename Layout, typename F>
+void forEachTiled(int na, int nb, F &&f) {
+    const int ta = Layout::TILE ? Layout::TILE : na;
+    const int tb = Layout::TILE ? Layout::TILE : nb;
+    for (int b0 = 0; b0 < nb; b0 += tb) {
+        for (int a0 = 0; a0 < na; a0 += ta) {
+            const int a1 = std::min(a0 + ta, na), b1 = std::min(b0 + tb, nb);
+            for (int b = b0; b < b1; ++b)
+                for (int a = a0; a < a1; ++a)
+                    f(a, b);
+        }
+    }
+}
+
+/// Calls f(x, y, z) for every cell of `extent`, tile by tile for `Layout`
+/// and x fastest within a tile, so writes land in (near) storage order.
+template <typename Layout, typename F>
+void forEachInLayoutOrder(const glm::ivec3 &extent, F &&f) {
+    const glm::ivec3 t = Layout::TILE ? glm::ivec3(Layout::TILE) : extent;
+    for (int z0 = 0; z0 < extent.z; z0 += t.z)
+        for (int y0 = 0; y0 < extent.y; y0 += t.y)
+            for (int x0 = 0; x0 < extent.x; x0 += t.x) {
+                const glm::ivec3 hi = glm::min(glm::ivec3(x0, y0, z0) + t,
+                                               extent);
+                for (int z = z0; z < hi.z; ++z)
+                    for (int y = y0; y < hi.y; ++y)
+                        for (int x = x0; x < hi.x; ++x)
+                            f(x, y, z);
+            }
+}
+
+} // namespace engine::voxel
@@ -6,9 +6,25 @@
 
 namespace engine::voxel {
 
+/// Wall-clock time spent sweeping each axis, summed over calls.
+struct MeshTimings {
+    double axisMs[3] = {0.0, 0.0, 0.0};
+};
+
 class VoxelMesher {
   public:
-    static std::unique_ptr<Mesh> GenerateMesh(const VoxelVolume &volume);
+    /// Greedy-meshes `volume`. Voxels outside the volume count as air, so
+    /// every chunk is closed by walls on its borders; those walls double as
+    /// skirts that hide cracks between neighbouring chunks of different LOD.
+    /// `voxelSize` scales the output for downsampled (LOD) volumes. Slices
+    /// are read in the volume's layout order; instantiated for the layouts
+    /// in VoxelLayout.hpp. Volumes the size of a chunk at any LOD go
+    /// through a variant specialised on that extent, with stack masks and
+    /// constant loop bounds; other sizes use the runtime-extent path.
+    template <typename Layout>
+    static std::unique_ptr<Mesh>
+    GenerateMesh(const BasicVoxelVolume<Layout> &volume, int voxelSize = 1,
+                 MeshTimings *timings = nullptr);
 };
 
 } // namespace engine::voxel
@@ -1,20 +1,150 @@
 #pragma once
 #include "engine/voxel/Voxel.hpp"
+#include "engine/voxel/VoxelLayout.hpp"
+#include <cassert>
+#include <cstdint>
 #include <glm/vec3.hpp>
+#include <span>
+#include <type_traits>
 #include <vector>
 
 namespace engine::voxel {
-class VoxelVolume {
+/// Dense voxel grid plus a 1-bit solid-occupancy sidecar. All writes go
+/// through set() or the bulk writers so the occupancy bits and per-section
+/// solid counts never drift from the voxel data.
+///
+/// Storage order comes from `Layout` (see VoxelLayout.hpp); occupancy bit
+/// i (word i / 64, bit i % 64) belongs to storage slot i. With LinearLayout
+/// voxel (x, y, z) lives at (z * extent.y + y) * extent.x + x: rows along
+/// x are contiguous, a step in y is strideY() voxels and a step in z is
+/// strideZ(). The row, column and stride accessors exist only for it.
+template <typename Layout> class BasicVoxelVolume {
   public:
-    VoxelVolume(const glm::ivec3 &extent);
-    Voxel &at(int x, int y, int z);
+    using layout_type = Layout;
+
+    // Sections are horizontal slabs this many voxels tall (16^3 in a chunk).
+    static constexpr int SECTION_HEIGHT = 16;
+
+    /// Strided view of the voxels along y at one (x, z).
+    struct Column {
+        const Voxel *base;
+        size_t stride;
+        int size;
+        const Voxel &operator[](int y) const { return base[y * stride]; }
+    };
+
+    BasicVoxelVolume(const glm::ivec3 &extent);
+    /// Re-lays out another volume's voxels.
+    template <typename Other>
+    explicit BasicVoxelVolume(const BasicVoxelVolume<Other> &other)
+        : BasicVoxelVolume(other.extent) {
+        forEachInLayoutOrder<Layout>(extent, [&](int x, int y, int z) {
+            setUnchecked(x, y, z, other.atUnchecked(x, y, z));
+        });
+    }
+
+    /// Bounds-checked, throwing std::out_of_range. Use while debugging or
+    /// on untrusted coordinates.
     const Voxel &at(int x, int y, int z) const;
+    void set(int x, int y, int z, const Voxel &voxel);
+
+    /// Unchecked counterparts for loops whose bounds are already validated.
+    /// Out-of-range coordinates are undefined behaviour (asserted in debug).
+    const Voxel &atUnchecked(int x, int y, int z) const {
+        assert(contains(x, y, z));
+        return data_[index(x, y, z)];
+    }
+    void setUnchecked(int x, int y, int z, const Voxel &voxel);
+
+    bool contains(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < extent.x && y < extent.y &&
+               z < extent.z;
+    }
+
+    /// Every storage slot in layout order, including any tile padding
+    /// (which stays default air).
+    std::span<const Voxel> voxels() const { return data_; }
+    /// Contiguous row of extent.x voxels at (y, z).
+    std::span<const Voxel> row(int y, int z) const
+        requires std::is_same_v<Layout, LinearLayout>
+    {
+        assert(contains(0, y, z));
+        return {data_.data() + index(0, y, z), size_t(extent.x)};
+    }
+    Column column(int x, int z) const
+        requires std::is_same_v<Layout, LinearLayout>
+    {
+        assert(contains(x, 0, z));
+        return {data_.data() + index(x, 0, z), strideY(), extent.y};
+    }
+    size_t strideY() const
+        requires std::is_same_v<Layout, LinearLayout>
+    {
+        return size_t(extent.x);
+    }
+    size_t strideZ() const
+        requires std::is_same_v<Layout, LinearLayout>
+    {
+        return size_t(extent.x) * size_t(extent.y);
+    }
+    /// Occupancy words, one bit per storage slot.
+    std::span<const uint64_t> occupancy() const { return occupancy_; }
+
+    /// Copies the box [mn, mx) into `out` in x-fastest order;
+    /// `out` must hold (mx - mn).x * .y * .z voxels. Both bulk calls check
+    /// the box once and throw std::out_of_range if it leaves the volume.
+    void copySlab(const glm::ivec3 &mn, const glm::ivec3 &mx,
+                  Voxel *out) const;
+    /// Writes `voxel` to every cell of the box [mn, mx). With LinearLayout
+    /// the occupancy is updated a row of bits at a time.
+    void fillRange(const glm::ivec3 &mn, const glm::ivec3 &mx,
+                   const Voxel &voxel);
+
+    /// Occupancy bit test; the hot path for meshing and raycasts.
+    bool isSolid(int x, int y, int z) const {
+        size_t i = index(x, y, z);
+        return (occupancy_[i >> 6] >> (i & 63)) & 1;
+    }
+
+    int sectionCount() const {
+        return (extent.y + SECTION_HEIGHT - 1) / SECTION_HEIGHT;
+    }
+    int sectionOf(int y) const { return y / SECTION_HEIGHT; }
+    bool sectionAllAir(int section) const {
+        return sectionSolid_[section] == 0;
+    }
+    bool sectionAllSolid(int section) const {
+        return sectionSolid_[section] == sectionVolume(section);
+    }
+
+    /// Box-filters the volume by `factor` along every axis. A coarse cell is
+    /// solid if any covered voxel is, and takes the colour of the topmost
+    /// solid voxel so surfaces keep their material.
+    BasicVoxelVolume downsample(int factor) const;
+
     glm::ivec3 extent;
 
   private:
+    glm::ivec3 padded_; // extent rounded up to whole layout tiles
     std::vector<Voxel> data_;
+    std::vector<uint64_t> occupancy_; // bit index(x, y, z)
+    std::vector<uint32_t> sectionSolid_;
+
     size_t index(int x, int y, int z) const {
-        return (z * extent.y + y) * extent.x + x;
+        return Layout::index(padded_, x, y, z);
     }
+    uint32_t sectionVolume(int section) const;
+    void checkBox(const glm::ivec3 &mn, const glm::ivec3 &mx) const;
 };
+
+extern template class BasicVoxelVolume<LinearLayout>;
+extern template class BasicVoxelVolume<Brick4Layout>;
+extern template class BasicVoxelVolume<MortonLayout>;
+
+// The layout the engine stores chunks in; pick another at configure time
+// with -DVOXEL_LAYOUT=Brick4Layout or MortonLayout.
+#ifndef VOXEL_LAYOUT
+#define VOXEL_LAYOUT LinearLayout
+#endif
+using VoxelVolume = BasicVoxelVolume<VOXEL_LAYOUT>;
 } // namespace engine::voxel
@@ -2,17 +2,30 @@
 
 #include "engine/render/Mesh.hpp"
 #include "engine/voxel/VoxelVolume.hpp"
+#include <functional>
 #include <glm/vec2.hpp>
 #include <memory>
 
 namespace engine::world {
 
+struct ivec2_hash {
+    std::size_t operator()(const glm::ivec2 &v) const noexcept {
+        return (std::hash<int>()(v.x) * 73856093u) ^
+               (std::hash<int>()(v.y) * 19349663u);
+    }
+};
+
 struct Chunk {
     glm::ivec2 coord;
     std::unique_ptr<engine::voxel::VoxelVolume> volume;
     std::unique_ptr<Mesh> mesh;
-    bool dirty = true;
+    bool dirty = true;  // mesh is stale relative to volume
+    bool edited = false; // volume differs from the saved copy
     bool meshJobQueued = false;
+    int lod = 0;
+    // Conservative solid height range; edits only ever widen it.
+    int solidMinY = 0;
+    int solidMaxY = -1;
 };
 
 } // namespace engine::world
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "engine/voxel/VoxelVolume.hpp"
+#include "engine/world/Chunk.hpp"
+#include "engine/world/RegionStore.hpp"
+#include <condition_variable>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace engine::world {
+
+/// Dedicated disk thread for the chunk pipeline, so ThreadPool workers never
+/// block on file I/O. Reads are served nearest-first; writes are coalesced
+/// per chunk (only the newest snapshot is kept) and flushed to the
+/// RegionStore in batches, grouped by region file.
+class ChunkIO {
+  public:
+    /// Receives the loaded volume, or nullptr if the chunk is not stored.
+    /// Runs on the I/O thread and should hand real work to the ThreadPool.
+    using LoadCallback =
+        std::function<void(std::unique_ptr<engine::voxel::VoxelVolume>)>;
+
+    explicit ChunkIO(RegionStore &store);
+    ~ChunkIO();
+
+    ChunkIO(const ChunkIO &) = delete;
+    ChunkIO &operator=(const ChunkIO &) = delete;
+
+    /// Lower `priority` is served first (e.g. distance to the player).
+    void requestLoad(const glm::ivec2 &coord, int priority, LoadCallback done);
+
+    /// Read-ahead hint for chunks the player is likely to need soon.
+    void prefetch(std::vector<glm::ivec2> coords);
+
+    /// Write-behind: replaces any older pending snapshot of the same chunk.
+    void queueWrite(const glm::ivec2 &coord,
+                    std::shared_ptr<const engine::voxel::VoxelVolume> volume);
+
+    /// Blocks until every write queued so far is on disk.
+    void flush();
+
+    /// Drops queued reads and waits for any read being served to finish.
+    void cancelReads();
+
+    size_t pendingReads() const;
+    size_t pendingWrites() const;
+
+  private:
+    struct ReadRequest {
+        glm::ivec2 coord;
+        LoadCallback done;
+    };
+
+    void run();
+    void serveRead(ReadRequest &req);
+    void writeBatch(std::unique_lock<std::mutex> &lock);
+
+    RegionStore &store_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::multimap<int, ReadRequest> reads_;
+    std::vector<glm::ivec2> prefetches_;
+    std::unordered_map<glm::ivec2,
+                       std::shared_ptr<const engine::voxel::VoxelVolume>,
+                       ivec2_hash>
+        writes_;
+    // Snapshots currently being written; reads consult these too.
+    std::unordered_map<glm::ivec2,
+                       std::shared_ptr<const engine::voxel::VoxelVolume>,
+                       ivec2_hash>
+        writing_;
+    bool reading_ = false;
+    bool flushRequested_ = false;
+    bool stop_ = false;
+
+    std::thread thread_;
+};
+
+} // namespace engine::world
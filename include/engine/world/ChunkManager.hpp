@@ -1,41 +1,123 @@
 #pragma once
 
 #include "engine/utils/ThreadPool.hpp"
+#include "engine/voxel/Voxel.hpp"
 #include "engine/world/Chunk.hpp"
+#include "engine/world/ChunkIO.hpp"
+#include "engine/world/ChunkQuadtree.hpp"
+#include "engine/world/RegionStore.hpp"
+#include "engine/world/WorldCoords.hpp"
 #include <glm/glm.hpp>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace engine::world {
 
-struct ivec2_hash {
-    std::size_t operator()(const glm::ivec2 &v) const noexcept {
-        return (std::hash<int>()(v.x) * 73856093u) ^
-               (std::hash<int>()(v.y) * 19349663u);
-    }
-};
-
 class ChunkManager {
   public:
     ChunkManager();
     void initChunks(engine::utils::ThreadPool &threadPool);
-    void updateChunks(const glm::vec3 &playerPos,
+    void updateChunks(const WorldPos &playerPos,
                       engine::utils::ThreadPool &threadPool);
 
+    /// Writes one voxel at a world-space position. Clearing is a write of a
+    /// default (non-solid) Voxel. Returns false if the owning chunk has no
+    /// resident volume yet. The remesh is deferred until flushEdits().
+    bool setVoxel(const VoxelCoord &worldPos,
+                  const engine::voxel::Voxel &voxel);
+
+    /// Writes every voxel in the inclusive world-space box [mn, mx].
+    /// Returns the number of voxels written.
+    size_t fillRegion(const VoxelCoord &mn, const VoxelCoord &mx,
+                      const engine::voxel::Voxel &voxel);
+
+    /// Enqueues at most one remesh per dirty chunk, nearest to the player
+    /// first and capped at MAX_REMESHES_PER_FRAME. Call once per frame on
+    /// the main thread; the new meshes replace the old ones through
+    /// installUploadedMeshes().
+    void flushEdits(const WorldPos &playerPos,
+                    engine::utils::ThreadPool &threadPool);
+
+    /// Drops queued chunk loads and waits for the one in progress, so no
+    /// further load callbacks reach the ThreadPool. Call before shutdown.
+    void cancelLoads();
+
+    /// Synchronously writes every edited chunk to the region store. Call
+    /// after the worker pool is idle, e.g. on shutdown.
+    void saveEditedChunks();
+
+    size_t pendingRemeshCount() const { return dirtyChunks_.size(); }
+
+    struct StreamingStats {
+        size_t meshed = 0;   // chunks with a GPU mesh
+        size_t inFlight = 0; // chunks with a load, mesh or upload queued
+        size_t pendingRemeshes = 0;
+    };
+    /// Snapshot of the chunk pipeline. Streaming has settled once nothing
+    /// is in flight or waiting for a remesh.
+    StreamingStats streamingStats() const;
+
     Chunk &getChunk(const glm::ivec2 &coord) { return chunks_[coord]; }
 
+    /// Moves volumes finished by load jobs into their chunks and records
+    /// them in the spatial index. Call once per frame on the main thread.
+    void installPendingVolumes();
+
+    /// Hands a mesh back from the upload thread; it replaces the chunk's
+    /// current mesh at the next installUploadedMeshes().
+    void installUploaded(const glm::ivec2 &coord, std::unique_ptr<Mesh> mesh);
+
+    /// Swaps uploaded meshes into their chunks and passes the meshes they
+    /// replace to `retired`. Call once per frame on the main thread, so the
+    /// renderer never sees a mesh change under it.
+    void installUploadedMeshes(MeshRetireQueue &retired);
+
+    /// Destroys every chunk mesh. Call on shutdown once the device is idle.
+    void releaseMeshes();
+
+    /// Resident chunks by solid height range; see ChunkQuadtree.
+    const ChunkQuadtree &spatialIndex() const { return index_; }
+
     const std::unordered_map<glm::ivec2, Chunk, ivec2_hash> &getChunks() const {
         return chunks_;
     }
 
-    std::unordered_map<glm::ivec2, std::unique_ptr<engine::voxel::VoxelVolume>,
-                       ivec2_hash>
-        chunkVolumesPending_;
-
-    mutable std::mutex assignMtx_;
+    /// LOD a chunk at Chebyshev distance `dist` should use, given the LOD
+    /// it currently has. Coarsening is delayed by LOD_HYSTERESIS chunks so
+    /// chunks on a threshold do not flip back and forth.
+    static int selectLod(int dist, int currentLod);
 
   private:
+    struct PendingVolume {
+        std::unique_ptr<engine::voxel::VoxelVolume> volume;
+        int minY, maxY; // solid range, minY > maxY if all air
+    };
+
+    void prefetchAhead(const glm::ivec2 &playerChunk);
+    void finishLoad(const glm::ivec2 &coord, int lod,
+                    const std::shared_ptr<engine::voxel::VoxelVolume> &loaded,
+                    engine::utils::ThreadPool &threadPool);
+    void enqueueRemesh(Chunk &chunk, const glm::ivec2 &coord, int lod,
+                       engine::utils::ThreadPool &threadPool);
+    Chunk *findResident(const glm::ivec2 &coord);
+    void markDirty(const glm::ivec2 &coord);
+    void markEdited(const glm::ivec2 &coord, const glm::ivec3 &localMin,
+                    const glm::ivec3 &localMax);
+
+    RegionStore regionStore_;
+    ChunkIO io_;
     std::unordered_map<glm::ivec2, Chunk, ivec2_hash> chunks_;
+    std::unordered_set<glm::ivec2, ivec2_hash> dirtyChunks_;
+    mutable std::mutex assignMtx_;
+    std::unordered_map<glm::ivec2, PendingVolume, ivec2_hash>
+        chunkVolumesPending_; // guarded by assignMtx_
+    std::vector<std::pair<glm::ivec2, std::unique_ptr<Mesh>>>
+        uploadedMeshes_; // guarded by assignMtx_
+    ChunkQuadtree index_;
+    glm::ivec2 lastPlayerChunk_{0};
 };
 
 } // namespace engine::world
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "engine/math/FrustumCulling.hpp"
+#include "engine/world/Chunk.hpp"
+#include "engine/world/WorldCoords.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace engine::world {
+
+/// Quadtree over resident chunks, kept as one hash map per level. A node at
+/// level L covers 2^L x 2^L chunks and is keyed by the chunk coordinate
+/// shifted right by L. Every node holds the solid height range of all
+/// chunks beneath it, so a query can reject a whole region, or a region of
+/// open air, with a single box test.
+class ChunkQuadtree {
+  public:
+    // Top-level nodes cover 64x64 chunks, about twice the view ring.
+    static constexpr int LEVELS = 7;
+
+    /// Inserts or updates a chunk with solid voxels in [minY, maxY]. Pass
+    /// minY > maxY for a chunk that is all air.
+    void update(const glm::ivec2 &chunk, int minY, int maxY);
+    void remove(const glm::ivec2 &chunk);
+    void clear();
+    size_t size() const { return levels_[0].size(); }
+
+    /// Appends chunks whose solid bounds may intersect the frustum. The
+    /// culler is built from Camera::relativeViewProjection() and boxes are
+    /// tested relative to `anchor`. Below `leafLevel` nodes are not tested:
+    /// every chunk under an accepted node at that level is returned, for
+    /// callers that batch-cull the candidates afterwards.
+    void queryFrustum(const math::FrustumCuller &culler,
+                      const CameraAnchor &anchor,
+                      std::vector<glm::ivec2> &out, int leafLevel = 0) const;
+
+    /// Appends chunks whose solid bounds intersect the sphere.
+    void querySphere(const WorldPos &center, double radius,
+                     std::vector<glm::ivec2> &out) const;
+
+    struct RayHit {
+        glm::ivec2 chunk;
+        double tEnter; // along `dir`, clamped to 0
+        double tExit;
+    };
+    /// Appends chunks whose solid bounds the ray crosses within `maxDist`,
+    /// nearest entry first. `dir` need not be normalised; t is in units of
+    /// its length.
+    void queryRay(const WorldPos &origin, const glm::dvec3 &dir,
+                  double maxDist, std::vector<RayHit> &out) const;
+
+  private:
+    struct Node {
+        int minY;
+        int maxY;
+        uint32_t chunks; // resident chunks below, including empty ones
+    };
+    using Level = std::unordered_map<glm::ivec2, Node, ivec2_hash>;
+
+    /// World-space bounds of a node's solid range.
+    static void nodeBounds(int level, const glm::ivec2 &node, const Node &n,
+                           glm::dvec3 &mn, glm::dvec3 &mx);
+    void refreshAncestors(const glm::ivec2 &chunk);
+    template <typename Accept>
+    void visit(int level, const glm::ivec2 &node, const Accept &accept,
+               int leafLevel, std::vector<glm::ivec2> &out) const;
+    void collectLeaves(int level, const glm::ivec2 &node,
+                       std::vector<glm::ivec2> &out) const;
+
+    Level levels_[LEVELS];
+};
+
+} // namespace engine::world
@@ -1,13 +1,50 @@
 #pragma once
 
+#include "engine/math/FrustumCulling.hpp"
 #include "engine/platform/RendererContext.hpp"
+#include "engine/utils/ThreadPool.hpp"
 #include "engine/world/ChunkManager.hpp"
+#include "engine/world/FarTerrain.hpp"
+#include <vector>
 
 namespace engine::world {
 
 class ChunkRenderSystem {
   public:
     void drawAll(RendererContext &ctx, const ChunkManager &chunks);
+    void drawFarTerrain(RendererContext &ctx, const FarTerrain &terrain);
+
+    /// Culls chunks and far tiles on the calling thread, records the
+    /// survivors into one secondary per record thread on `pool`, then
+    /// executes them from the current primary.
+    void drawParallel(RendererContext &ctx, const ChunkManager &chunks,
+                      const FarTerrain &terrain, utils::ThreadPool &pool);
+
+  private:
+    struct DrawItem {
+        VkBuffer vertexBuffer; // vertices, then the MeshInstance
+        VkDeviceSize instanceOffset;
+        VkBuffer indexBuffer;
+        uint32_t indexCount;
+    };
+
+    /// Gather candidate meshes and their camera-relative bounds, then cull
+    /// them as one batch into `out`.
+    void collectChunks(RendererContext &ctx, const ChunkManager &mgr,
+                       std::vector<DrawItem> &out);
+    void collectFarTiles(RendererContext &ctx, const FarTerrain &terrain,
+                         std::vector<DrawItem> &out);
+    void emitVisible(const math::FrustumCuller &culler,
+                     std::vector<DrawItem> &out);
+    static void record(VkCommandBuffer cmd, const DrawItem *begin,
+                       const DrawItem *end);
+
+    std::vector<DrawItem> draws_;
+    // Reused across frames to avoid reallocating per cull.
+    std::vector<glm::ivec2> coords_;
+    math::AabbSoA bounds_;
+    std::vector<const Mesh *> candidates_;
+    std::vector<uint64_t> visible_;
 };
 
 } // namespace engine::world
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <glm/ext/vector_int3.hpp>
 namespace engine::world {
 
@@ -7,5 +8,43 @@ inline constexpr int VIEW_RADIUS = 16;
 
 inline constexpr glm::ivec3 CHUNK_DIM = {16, 256, 16};
 
+inline constexpr int MAX_REMESHES_PER_FRAME = 32;
+
+// Chebyshev chunk distance at which LOD 1, 2 and 3 (2x, 4x, 8x voxels) start.
+inline constexpr int LOD_DISTANCES[] = {6, 10, 13};
+inline constexpr int LOD_HYSTERESIS = 1;
+
+// Far-field heightmap tiles drawn beyond the voxel ring.
+inline constexpr int FAR_TILE_CHUNKS = 8;
+inline constexpr int FAR_TERRAIN_RADIUS = 12; // in tiles
+inline constexpr int FAR_TERRAIN_SINK = 4;    // voxels, hides overlap
+
+inline constexpr const char *WORLD_SAVE_DIR = "world";
+// Rows of chunks beyond VIEW_RADIUS prefetched in the direction of travel.
+inline constexpr int PREFETCH_DEPTH = 2;
+// Chunk I/O thread: reads served between write batches, and the number of
+// pending writes that forces a batch even while reads are queued.
+inline constexpr int IO_READ_BATCH = 16;
+inline constexpr int IO_WRITE_BATCH = 64;
+
+// Default CPU/GPU pipelining depth; override with --frames-in-flight.
+inline constexpr size_t FRAMES_IN_FLIGHT = 2;
+// Default main loop frame cap in Hz, 0 for uncapped; override with --fps-cap.
+inline constexpr double TARGET_FPS = 0.0;
+// Simulated time per frame when replaying a --camera-path benchmark.
+inline constexpr float BENCHMARK_TIMESTEP = 1.0f / 60.0f;
+// Seconds a benchmark waits for chunk streaming to settle before going on.
+inline constexpr double SETTLE_TIMEOUT = 120.0;
+// Seconds between keyframes written by --record-path.
+inline constexpr double CAMERA_RECORD_INTERVAL = 0.25;
+
+// Size of each frame's region in the uniform ring (camera, per-chunk and
+// lighting constants).
+inline constexpr size_t UNIFORM_RING_BYTES_PER_FRAME = 64 * 1024;
+
+// Threads recording chunk draws into secondary command buffers; 0 records
+// everything inline on the primary.
+inline constexpr int RECORD_THREADS = 4;
+
 inline constexpr bool DEBUG = true;
 } // namespace engine::world
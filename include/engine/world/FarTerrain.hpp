@@ -0,0 +1,83 @@
+#pragma once
+
+#include "engine/render/Mesh.hpp"
+#include "engine/utils/ThreadPool.hpp"
+#include "engine/world/Chunk.hpp"
+#include "engine/world/WorldCoords.hpp"
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace engine::world {
+
+/// One heightmap tile of FAR_TILE_CHUNKS x FAR_TILE_CHUNKS chunks. Only the
+/// grid mesh is kept; no voxel data is ever allocated for the far field.
+struct FarTile {
+    glm::ivec2 coord;
+    int step = 0; // voxels between height samples, 0 = not built yet
+    float minY = 0.0f;
+    float maxY = 0.0f;
+    std::unique_ptr<Mesh> mesh;
+    bool jobQueued = false;
+};
+
+struct FarTileBuild {
+    glm::ivec2 coord;
+    int step;
+    float minY;
+    float maxY;
+    std::unique_ptr<Mesh> mesh;
+};
+
+/// Horizon tier behind the voxel ring. Tiles are sampled straight from
+/// TerrainGenerator::SampleColumn with a spacing that doubles with distance
+/// (a coarse clipmap), skirted on every edge and sunk by FAR_TERRAIN_SINK so
+/// the voxel terrain wins the depth test wherever both exist.
+class FarTerrain {
+  public:
+    /// Installs uploaded tiles, schedules (re)builds around the player and
+    /// evicts tiles beyond FAR_TERRAIN_RADIUS. Meshes replaced or evicted
+    /// go to `retired`.
+    void update(const WorldPos &playerPos,
+                engine::utils::ThreadPool &threadPool,
+                MeshRetireQueue &retired);
+
+    /// CPU meshes finished by workers, ready for GPU upload.
+    std::vector<FarTileBuild> collectBuilt();
+
+    /// Hands an uploaded tile back; safe to call from the upload thread.
+    void installUploaded(FarTileBuild &&build);
+
+    /// Destroys every tile mesh. Call on shutdown once the device is idle.
+    void releaseMeshes();
+
+    /// True if the tile lies entirely inside the voxel ring around
+    /// `playerChunk` and therefore must not be drawn.
+    static bool coveredByVoxels(const glm::ivec2 &tile,
+                                const glm::ivec2 &playerChunk);
+
+    const std::unordered_map<glm::ivec2, FarTile, ivec2_hash> &
+    getTiles() const {
+        return tiles_;
+    }
+    glm::ivec2 getPlayerChunk() const { return playerChunk_; }
+    /// Tiles with a build or upload outstanding.
+    size_t pendingBuilds() const;
+
+  private:
+    static std::unique_ptr<Mesh> buildTileMesh(const glm::ivec2 &tile,
+                                               int step, float &minY,
+                                               float &maxY);
+
+    std::unordered_map<glm::ivec2, FarTile, ivec2_hash> tiles_;
+    glm::ivec2 playerChunk_{0};
+
+    std::mutex builtMtx_;
+    std::vector<FarTileBuild> built_;
+    std::mutex uploadedMtx_;
+    std::vector<FarTileBuild> uploaded_;
+};
+
+} // namespace engine::world
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "engine/voxel/VoxelVolume.hpp"
+#include "engine/world/Chunk.hpp"
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace engine::world {
+
+/// On-disk chunk store. Chunks are grouped REGION_SIZE x REGION_SIZE per
+/// file ("r.<x>.<z>.region"). Each file starts with a fixed header:
+///
+///   char     magic[4]   "VXRG"
+///   uint32_t version
+///   uint32_t regionSize
+///   uint32_t reserved
+///   Entry    table[REGION_SIZE * REGION_SIZE]   {u64 offset, u32 size, u32}
+///
+/// followed by chunk blobs. Saving appends a new blob and repoints the
+/// table entry; the old blob becomes garbage until compact() rewrites the
+/// file. All values are little-endian, written in host order; the store
+/// only builds for little-endian hosts.
+///
+/// On POSIX systems region files are read through a shared read-only
+/// mapping and blobs are decoded straight from the page cache into the
+/// destination volume; other platforms fall back to buffered reads.
+class RegionStore {
+  public:
+    static constexpr int REGION_SIZE = 32;
+    static constexpr uint32_t VERSION = 1;
+
+    explicit RegionStore(std::string directory);
+
+    /// Decodes the stored chunk into `out`. Returns false if the chunk has
+    /// never been saved or its blob does not match `out.extent`.
+    bool load(const glm::ivec2 &chunk, engine::voxel::VoxelVolume &out);
+    void save(const glm::ivec2 &chunk, const engine::voxel::VoxelVolume &vol);
+
+    /// Saves many chunks at once: one append and one table write per region.
+    void saveBatch(const std::vector<
+                   std::pair<glm::ivec2, const engine::voxel::VoxelVolume *>>
+                       &chunks);
+
+    /// Asks the kernel to start reading a stored chunk's pages in the
+    /// background (madvise WILLNEED). No-op if the chunk is not stored.
+    void prefetch(const glm::ivec2 &chunk);
+
+    /// Rewrites a region file with only its live blobs.
+    void compact(const glm::ivec2 &region);
+
+    /// Blob format: extent, palette of distinct voxels, then (run, index)
+    /// pairs as LEB128 varints over the volume in memory order.
+    static std::vector<uint8_t> encode(const engine::voxel::VoxelVolume &vol);
+    static bool decode(const uint8_t *data, size_t size,
+                       engine::voxel::VoxelVolume &out);
+
+  private:
+    struct Entry {
+        uint64_t offset = 0;
+        uint32_t size = 0;
+        uint32_t reserved = 0;
+    };
+    static_assert(sizeof(Entry) == 16, "region table entries are 16 bytes");
+    struct Mapping;
+    struct Region {
+        std::array<Entry, REGION_SIZE * REGION_SIZE> table{};
+        uint64_t fileSize = 0;
+        uint64_t garbage = 0;
+        // Readers hold their own reference, so remapping after an append or
+        // compaction never unmaps memory that is still being decoded.
+        std::shared_ptr<const Mapping> map;
+    };
+
+    static glm::ivec2 regionOf(const glm::ivec2 &chunk);
+    static int slotOf(const glm::ivec2 &chunk);
+    std::string pathOf(const glm::ivec2 &region) const;
+    Region &openRegion(const glm::ivec2 &region);
+    std::shared_ptr<const Mapping> mapEntry(const glm::ivec2 &region,
+                                            Region &r, const Entry &e);
+    void compactLocked(const glm::ivec2 &region, Region &r);
+
+    std::string directory_;
+    std::mutex mtx_;
+    std::unordered_map<glm::ivec2, Region, ivec2_hash> regions_;
+};
+
+} // namespace engine::world
@@ -4,9 +4,23 @@
 
 namespace engine::world {
 
+/// Surface description of one terrain column, before trees are placed.
+struct ColumnHeights {
+    int baseHeight;     // top of the grass layer
+    int mountainHeight; // extra rock stacked on top of baseHeight
+};
+
 class TerrainGenerator {
   public:
-    static void Generate(engine::voxel::VoxelVolume &vol,
+    /// Samples the height noise for world column (wx, wz). Shared by the
+    /// voxel generator and the far-terrain heightmap tiles so both agree.
+    static ColumnHeights SampleColumn(float wx, float wz);
+
+    /// Fills `vol` with the terrain of the chunk at `chunkCoord`, visiting
+    /// cells in the volume's layout order. Instantiated for the layouts in
+    /// VoxelLayout.hpp.
+    template <typename Layout>
+    static void Generate(engine::voxel::BasicVoxelVolume<Layout> &vol,
                          const glm::ivec3 &chunkCoord);
 };
 
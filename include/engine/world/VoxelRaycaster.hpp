@@ -0,0 +1,50 @@
+#pragma once
+
+#include "engine/utils/ThreadPool.hpp"
+#include "engine/voxel/Voxel.hpp"
+#include "engine/world/ChunkManager.hpp"
+#include "engine/world/WorldCoords.hpp"
+#include <optional>
+#include <vector>
+
+namespace engine::world {
+
+struct Ray {
+    WorldPos origin;
+    glm::dvec3 dir; // need not be normalised
+    double maxDist;
+};
+
+struct VoxelHit {
+    VoxelCoord voxel;
+    glm::ivec3 normal; // face entered through; zero if the ray starts inside
+    double distance;   // from the ray origin, in voxels
+    engine::voxel::Voxel value;
+};
+
+/// 3D-DDA traversal of the resident voxel world. The walk crosses chunk
+/// borders freely; chunks that are not resident count as air. Missing
+/// chunks, all-air sections and the space outside a chunk's solid height
+/// range are crossed in one jump to their far boundary, so only voxels
+/// in mixed sections are stepped through; voxel data is read once, for
+/// the hit. Must not overlap ChunkManager updates or edits, which mutate
+/// the chunks being read.
+class VoxelRaycaster {
+  public:
+    /// Throws std::invalid_argument if the origin, direction or maxDist
+    /// is not finite.
+    static std::optional<VoxelHit> Trace(const ChunkManager &chunks,
+                                         const Ray &ray);
+
+    /// Traces every ray and returns once all are done; hits[i] answers
+    /// rays[i]. The calling thread works through the batch itself and
+    /// `pool` workers only help as they come free, so a backlog of
+    /// streaming jobs cannot stall it and calling from a pool worker is
+    /// safe.
+    static void TraceBatch(const ChunkManager &chunks,
+                           const std::vector<Ray> &rays,
+                           std::vector<std::optional<VoxelHit>> &hits,
+                           engine::utils::ThreadPool &pool);
+};
+
+} // namespace engine::world
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "engine/world/Config.hpp"
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+namespace engine::world {
+
+/// CPU-side world space. Positions are doubles and voxel coordinates 64-bit
+/// so neither degrades far from spawn; only camera-relative values are
+/// narrowed to float for the GPU. Chunk coordinates stay 32-bit, which
+/// already spans 2^35 voxels per axis.
+using WorldPos = glm::dvec3;
+using VoxelCoord = glm::i64vec3;
+
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && (a < 0));
+}
+
+inline glm::ivec2 chunkOf(const VoxelCoord &v) {
+    return {int(floorDiv(v.x, CHUNK_DIM.x)), int(floorDiv(v.z, CHUNK_DIM.z))};
+}
+
+inline glm::ivec2 chunkOf(const WorldPos &p) {
+    return {int(std::floor(p.x / CHUNK_DIM.x)),
+            int(std::floor(p.z / CHUNK_DIM.z))};
+}
+
+inline VoxelCoord chunkOrigin(const glm::ivec2 &chunk) {
+    return {int64_t(chunk.x) * CHUNK_DIM.x, 0, int64_t(chunk.y) * CHUNK_DIM.z};
+}
+
+/// A position split into its chunk and the small offset from that chunk's
+/// origin, which is exact enough in float.
+struct CameraAnchor {
+    glm::ivec2 chunk;
+    glm::vec3 offset;
+};
+
+inline CameraAnchor anchorOf(const WorldPos &p) {
+    const glm::ivec2 chunk = chunkOf(p);
+    return {chunk, glm::vec3(p - WorldPos(chunkOrigin(chunk)))};
+}
+
+/// Origin of `chunk` relative to the anchored position. The chunk delta is
+/// integer, so the result is exact at any distance from the world origin.
+inline glm::vec3 relativeOrigin(const glm::ivec2 &chunk,
+                                const CameraAnchor &anchor) {
+    const glm::ivec2 d = chunk - anchor.chunk;
+    return glm::vec3(float(d.x * CHUNK_DIM.x), 0.0f,
+                     float(d.y * CHUNK_DIM.z)) -
+           anchor.offset;
+}
+
+} // namespace engine::world
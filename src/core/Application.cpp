@@ -1,4 +1,6 @@
 #include "engine/core/Application.hpp"
+#include "engine/core/BenchmarkReport.hpp"
+#include "engine/render/CameraPath.hpp"
 #include "engine/world/Chunk.hpp"
 #include "engine/world/Config.hpp"
 #include <engine/render/Camera.hpp>
@@ -8,82 +10,271 @@
 #include <imgui.h>
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
 #include <glm/glm.hpp>
+#include <iostream>
+#include <map>
+#include <thread>
 
 using namespace engine;
 using namespace engine::world;
 
-Application::Application()
-    : windowManager_(1280, 720, "Vulkan Voxel World"),
+Application::Application(const LaunchOptions &options)
+    : windowManager_(options.headless ? nullptr
+                                      : std::make_unique<WindowManager>(
+                                            options.width, options.height,
+                                            "Vulkan Voxel World")),
       threadPool_(std::thread::hardware_concurrency()), chunkManager_(),
-      chunkRenderer_(), rendererContext_(windowManager_.getWindow()),
-      inputManager_(windowManager_.getWindow(), rendererContext_.camera()),
-      uploadPool_(1) {
+      farTerrain_(), chunkRenderer_(),
+      rendererContext_(window(), {options.width, options.height},
+                       options.framesInFlight, options.presentMode),
+      uploadPool_(1), recordPool_(std::max(1, RECORD_THREADS)),
+      frameLimiter_(options.targetFps), imgui_(DEBUG && !options.headless),
+      cameraPath_(options.cameraPath), reportPath_(options.reportPath),
+      recordPathFile_(options.recordPath), lockstep_(options.lockstep) {
+    if (!recordPathFile_.empty())
+        recordPath_ = std::make_unique<render::CameraPath>();
 
-    glfwSetInputMode(windowManager_.getWindow(), GLFW_CURSOR,
-                     GLFW_CURSOR_DISABLED);
+    if (windowManager_) {
+        inputManager_ = std::make_unique<InputManager>(
+            window(), rendererContext_.camera());
+        glfwSetInputMode(window(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
 
-    if (DEBUG) {
-        rendererContext_.initImGui(windowManager_.getWindow());
+    if (imgui_) {
+        rendererContext_.initImGui(window());
     }
+    buildRenderGraph();
 
     chunkManager_.initChunks(threadPool_);
 }
 
 Application::~Application() {
+    chunkManager_.cancelLoads();
     threadPool_.waitIdle();
     uploadPool_.waitIdle();
+    chunkManager_.saveEditedChunks();
     vkDeviceWaitIdle(rendererContext_.getDevice()->getDevice());
+    // Meshes hold buffers on the device, which rendererContext_ destroys
+    // before the world members go.
+    chunkManager_.releaseMeshes();
+    farTerrain_.releaseMeshes();
+    retiredMeshes_.clear();
 
-    if (DEBUG) {
+    if (imgui_) {
         rendererContext_.cleanupImGui();
     }
 }
 
+GLFWwindow *Application::window() const {
+    return windowManager_ ? windowManager_->getWindow() : nullptr;
+}
+
+void Application::buildRenderGraph() {
+    using Access = RenderGraph::Access;
+    using LoadOp = RenderGraph::LoadOp;
+    RenderGraph &graph = rendererContext_.getRenderGraph();
+    const RenderGraph::ResourceId backbuffer = rendererContext_.backbuffer();
+    const RenderGraph::ResourceId depth = rendererContext_.depthTarget();
+
+    graph.addPass(
+        "scene", RenderGraph::PassType::Graphics,
+        [&](RenderGraph::PassBuilder &pass) {
+            VkClearValue color{};
+            color.color = {{0.1f, 0.1f, 0.1f, 1.0f}};
+            VkClearValue depthClear{};
+            depthClear.depthStencil = {1.0f, 0};
+            pass.write(backbuffer, Access::ColorAttachment, LoadOp::Clear,
+                       color);
+            pass.write(depth, Access::DepthAttachment, LoadOp::Clear,
+                       depthClear);
+            if (rendererContext_.parallelRecording())
+                pass.useSecondaryCommandBuffers();
+        },
+        [this](VkCommandBuffer cmd) { recordScene(cmd); });
+
+    if (imgui_) {
+        graph.addPass(
+            "imgui", RenderGraph::PassType::Graphics,
+            [&](RenderGraph::PassBuilder &pass) {
+                pass.write(backbuffer, Access::ColorAttachment);
+            },
+            [](VkCommandBuffer cmd) {
+                ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+            });
+    }
+}
+
+void Application::recordScene(VkCommandBuffer cmd) {
+    if (rendererContext_.parallelRecording()) {
+        chunkRenderer_.drawParallel(rendererContext_, chunkManager_,
+                                    farTerrain_, recordPool_);
+        return;
+    }
+
+    rendererContext_.getRenderResources().bindPipeline(cmd);
+    chunkRenderer_.drawAll(rendererContext_, chunkManager_);
+    chunkRenderer_.drawFarTerrain(rendererContext_, farTerrain_);
+}
+
 void Application::Run() {
-    while (!windowManager_.shouldClose())
+    if (!cameraPath_.empty()) {
+        runBenchmark();
+        return;
+    }
+    while (!windowManager_->shouldClose())
         mainLoop();
+    if (recordPath_ && !recordPath_->empty()) {
+        recordPath_->save(recordPathFile_);
+        std::cout << "Recorded camera path to " << recordPathFile_
+                  << std::endl;
+    }
 }
 
 void Application::mainLoop() {
-    windowManager_.pollEvents();
-    if (WindowManager::framebufferResized) {
-        WindowManager::framebufferResized = false;
-        rendererContext_.recreateSwapchain();
-    }
+    frameLimiter_.wait();
+    // Block on the GPU before polling, not after, so the input that drives
+    // this frame is sampled as late as possible.
+    rendererContext_.waitForFrame();
+    pollWindow();
 
     static double lastTime = glfwGetTime();
     double now = glfwGetTime();
     float dt = float(now - lastTime);
     lastTime = now;
-    inputManager_.processInput(dt);
-    rendererContext_.beginFrame();
-    VkCommandBuffer cmd = rendererContext_.getCurrentCommandBuffer();
-    size_t frame = rendererContext_.getFrameIndex();
+    inputManager_->processInput(dt);
+    // Sample at a fixed interval; the spline fills in between on replay.
+    if (recordPath_ && now >= nextRecordSample_) {
+        if (recordPath_->empty())
+            recordStart_ = now;
+        const render::Camera &cam = rendererContext_.camera();
+        recordPath_->addKeyframe({float(now - recordStart_),
+                                  cam.getPosition(), cam.getYaw(),
+                                  cam.getPitch()});
+        nextRecordSample_ = now + CAMERA_RECORD_INTERVAL;
+    }
+    tick(dt);
+}
 
-    vkCmdResetQueryPool(cmd, rendererContext_.pipelineStatsQueryPool_, frame,
-                        1);
-    vkCmdBeginQuery(cmd, rendererContext_.pipelineStatsQueryPool_, frame, 0);
+void Application::pollWindow() {
+    if (!windowManager_)
+        return;
+    windowManager_->pollEvents();
+    if (WindowManager::framebufferResized) {
+        WindowManager::framebufferResized = false;
+        rendererContext_.recreateSwapchain();
+    }
+}
 
-    vkCmdResetQueryPool(cmd, rendererContext_.occlusionQueryPool_, frame, 1);
-    vkCmdBeginQuery(cmd, rendererContext_.occlusionQueryPool_, frame, 0);
+bool Application::settleStreaming(const std::function<void()> &onFrameWaited) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double>(SETTLE_TIMEOUT));
+    for (;;) {
+        rendererContext_.waitForFrame();
+        if (onFrameWaited)
+            onFrameWaited();
+        pollWindow();
+        tick(0.0f);
+        ChunkManager::StreamingStats stats = chunkManager_.streamingStats();
+        if (stats.inFlight == 0 && stats.pendingRemeshes == 0 &&
+            farTerrain_.pendingBuilds() == 0)
+            return true;
+        if (Clock::now() > deadline)
+            return false;
+        // Leave the cores to the loaders and meshers.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
 
-    chunkRenderer_.drawAll(rendererContext_, chunkManager_);
+void Application::runBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    const render::CameraPath path = render::CameraPath::load(cameraPath_);
+    const size_t frames =
+        static_cast<size_t>(path.duration() / BENCHMARK_TIMESTEP) + 1;
+
+    // Every run starts from the same world state: the first pose with all
+    // chunks and far tiles around it resident.
+    path.apply(0.0f, rendererContext_.camera());
+    if (!settleStreaming())
+        std::cerr << "benchmark: streaming did not settle within "
+                  << SETTLE_TIMEOUT << " s" << std::endl;
+
+    // GPU results for a frame arrive when its slot comes round again; keep
+    // the CPU half until then, keyed by frame number.
+    BenchmarkReport report;
+    std::map<uint64_t, BenchmarkReport::Frame> pending;
+    auto collect = [&]() {
+        RendererContext::FrameStats stats =
+            rendererContext_.retiredFrameStats();
+        auto it = pending.find(stats.frame);
+        if (it == pending.end())
+            return;
+        BenchmarkReport::Frame frame = it->second;
+        frame.gpuMs = stats.gpuMs;
+        frame.submittedTris = stats.submittedTris;
+        frame.rasterizedTris = stats.rasterizedTris;
+        frame.fragments = stats.fragments;
+        report.add(frame);
+        pending.erase(it);
+    };
+
+    for (size_t i = 0; i < frames; ++i) {
+        if (windowManager_ && windowManager_->shouldClose())
+            break;
+        path.apply(float(i) * BENCHMARK_TIMESTEP, rendererContext_.camera());
+        if (lockstep_ && !settleStreaming(collect))
+            std::cerr << "benchmark: frame " << i << " did not settle"
+                      << std::endl;
 
-    vkCmdEndQuery(cmd, rendererContext_.pipelineStatsQueryPool_, frame);
-    vkCmdEndQuery(cmd, rendererContext_.occlusionQueryPool_, frame);
+        Clock::time_point start = Clock::now();
+        rendererContext_.waitForFrame();
+        collect();
+        pollWindow();
 
-    glm::vec3 camPos = rendererContext_.camera().getPosition();
+        BenchmarkReport::Frame frame{};
+        const uint64_t number = rendererContext_.frameNumber();
+        Clock::time_point cpuStart = Clock::now();
+        frame.chunkUploads = tick(BENCHMARK_TIMESTEP);
+        Clock::time_point end = Clock::now();
+        frame.frameMs = Ms(end - start).count();
+        frame.cpuMs = Ms(end - cpuStart).count();
+
+        ChunkManager::StreamingStats stats = chunkManager_.streamingStats();
+        frame.chunksMeshed = stats.meshed;
+        frame.chunksInFlight = stats.inFlight;
+        pending.emplace(number, frame);
+    }
+    // Retire the frames still in flight so the report covers every one;
+    // each wait retires one, so framesInFlight waits drain them all.
+    for (size_t i = 0;
+         !pending.empty() && i < rendererContext_.framesInFlight(); ++i) {
+        rendererContext_.waitForFrame();
+        collect();
+        tick(0.0f);
+    }
+
+    report.printSummary(std::cout);
+    if (!reportPath_.empty())
+        report.writeCsv(reportPath_);
+}
+
+size_t Application::tick(float dt) {
+    rendererContext_.beginFrame();
+    retiredMeshes_.advance(rendererContext_.frameNumber(),
+                           rendererContext_.framesInFlight());
+    chunkManager_.installUploadedMeshes(retiredMeshes_);
+
+    const glm::dvec3 camPos = rendererContext_.camera().getPosition();
     chunkManager_.updateChunks(camPos, threadPool_);
+    chunkManager_.flushEdits(camPos, threadPool_);
+    farTerrain_.update(camPos, threadPool_, retiredMeshes_);
 
     auto meshResults = threadPool_.collectResults();
-    {
-        std::lock_guard<std::mutex> lock(chunkManager_.assignMtx_);
-        for (auto &p : chunkManager_.chunkVolumesPending_) {
-            chunkManager_.getChunk(p.first).volume = std::move(p.second);
-        }
-        chunkManager_.chunkVolumesPending_.clear();
-    }
+    chunkManager_.installPendingVolumes();
 
     for (auto &r : meshResults) {
         glm::ivec2 coord2{r.coord.x, r.coord.z};
@@ -92,14 +283,19 @@ void Application::mainLoop() {
         uploadPool_.enqueueJob([this, coord2, rawMesh]() {
             std::unique_ptr<Mesh> meshUp(rawMesh);
             meshUp->uploadToGPU(rendererContext_.getDevice());
-            std::lock_guard<std::mutex> lock(chunkManager_.assignMtx_);
-            auto &chunk = chunkManager_.getChunk(coord2);
-            chunk.mesh = std::move(meshUp);
-            chunk.dirty = false;
-            chunk.meshJobQueued = false;
+            chunkManager_.installUploaded(coord2, std::move(meshUp));
+        });
+    }
+    size_t uploads = meshResults.size();
+    for (auto &b : farTerrain_.collectBuilt()) {
+        ++uploads;
+        auto build = std::make_shared<FarTileBuild>(std::move(b));
+        uploadPool_.enqueueJob([this, build]() {
+            build->mesh->uploadToGPU(rendererContext_.getDevice());
+            farTerrain_.installUploaded(std::move(*build));
         });
     }
-    if (DEBUG) {
+    if (imgui_) {
         ImGui_ImplVulkan_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -107,25 +303,31 @@ void Application::mainLoop() {
         ImGui::SetNextWindowSize(ImVec2(400, 200), ImGuiCond_FirstUseEver);
         ImGui::Begin("Debug Info");
         ImGui::Text("FPS: %.1f", 1.0f / dt);
+        ImGui::Text("Present mode: %s, cap: %.0f",
+                    presentModeName(
+                        rendererContext_.getSwapchain()->getPresentMode()),
+                    frameLimiter_.target());
         ImGui::Text("Camera Pos: (%.2f, %.2f, %.2f)", camPos.x, camPos.y,
                     camPos.z);
 
-        size_t lastSlot = (frame + RendererContext::MAX_FRAMES_IN_FLIGHT - 1) %
-                          RendererContext::MAX_FRAMES_IN_FLIGHT;
-        ImGui::Text(
-            "Submitted tris:  %llu",
-            (unsigned long long)rendererContext_.statsSubmitted_[lastSlot]);
-        ImGui::Text(
-            "Rasterized tris: %llu",
-            (unsigned long long)rendererContext_.statsRasterized_[lastSlot]);
-        ImGui::Text(
-            "Fragments drawn:  %llu",
-            (unsigned long long)rendererContext_.statsSamples_[lastSlot]);
+        RendererContext::FrameStats stats =
+            rendererContext_.retiredFrameStats();
+        ImGui::Text("Submitted tris:  %llu",
+                    (unsigned long long)stats.submittedTris);
+        ImGui::Text("Rasterized tris: %llu",
+                    (unsigned long long)stats.rasterizedTris);
+        ImGui::Text("Fragments drawn:  %llu",
+                    (unsigned long long)stats.fragments);
+        const RenderGraph &graph = rendererContext_.getRenderGraph();
+        ImGui::Text("Transient memory: %.1f MiB (%.1f MiB aliased)",
+                    graph.transientBytes() / (1024.0 * 1024.0),
+                    graph.aliasedBytes() / (1024.0 * 1024.0));
         ImGui::End();
 
         ImGui::Render();
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
     }
 
+    // Records the graph: scene, then the ImGui overlay.
     rendererContext_.endFrame();
+    return uploads;
 }
@@ -0,0 +1,73 @@
+#include "engine/core/BenchmarkReport.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+// Nearest-rank percentile of an ascending sequence.
+double percentile(const std::vector<double> &sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void printTimes(std::ostream &out, const char *label,
+                std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    double total = 0.0;
+    for (double v : ms)
+        total += v;
+    out << "  " << label << " ms  mean " << total / ms.size() << "  p50 "
+        << percentile(ms, 0.50) << "  p95 " << percentile(ms, 0.95)
+        << "  p99 " << percentile(ms, 0.99) << "  max " << ms.back() << "\n";
+}
+} // namespace
+
+void BenchmarkReport::printSummary(std::ostream &out) const {
+    if (frames_.empty()) {
+        out << "benchmark: no frames recorded\n";
+        return;
+    }
+
+    std::vector<double> frameMs, cpuMs, gpuMs;
+    double totalMs = 0.0;
+    double submitted = 0.0, rasterized = 0.0, fragments = 0.0;
+    size_t uploads = 0;
+    for (const Frame &f : frames_) {
+        frameMs.push_back(f.frameMs);
+        cpuMs.push_back(f.cpuMs);
+        gpuMs.push_back(f.gpuMs);
+        totalMs += f.frameMs;
+        submitted += double(f.submittedTris);
+        rasterized += double(f.rasterizedTris);
+        fragments += double(f.fragments);
+        uploads += f.chunkUploads;
+    }
+    const double n = double(frames_.size());
+
+    out << "benchmark: " << frames_.size() << " frames, "
+        << 1000.0 * n / totalMs << " fps\n";
+    printTimes(out, "frame", frameMs);
+    printTimes(out, "cpu  ", cpuMs);
+    printTimes(out, "gpu  ", gpuMs);
+    out << "  per frame  submitted tris " << uint64_t(submitted / n)
+        << "  rasterized tris " << uint64_t(rasterized / n) << "  fragments "
+        << uint64_t(fragments / n) << "\n"
+        << "  chunks     meshed at end " << frames_.back().chunksMeshed
+        << "  uploads " << uploads << "\n";
+}
+
+void BenchmarkReport::writeCsv(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to open report " + path);
+    file << "frame,frame_ms,cpu_ms,gpu_ms,submitted_tris,rasterized_tris,"
+            "fragments,chunks_meshed,chunks_in_flight,chunk_uploads\n";
+    for (size_t i = 0; i < frames_.size(); ++i) {
+        const Frame &f = frames_[i];
+        file << i << ',' << f.frameMs << ',' << f.cpuMs << ',' << f.gpuMs
+             << ',' << f.submittedTris << ',' << f.rasterizedTris << ','
+             << f.fragments << ',' << f.chunksMeshed << ','
+             << f.chunksInFlight << ',' << f.chunkUploads << '\n';
+    }
+}
@@ -0,0 +1,129 @@
+#include "engine/core/LaunchOptions.hpp"
+#include "engine/platform/RendererContext.hpp"
+#include "engine/world/Config.hpp"
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+/// Parses a whole decimal string in [lo, hi]. std::stoul alone accepts a
+/// leading minus and wraps it, and trailing garbage.
+size_t parseCount(const std::string &option, const std::string &value,
+                  size_t lo, size_t hi) {
+    const std::string range =
+        std::to_string(lo) + " and " + std::to_string(hi);
+    if (value.empty() || value.find_first_not_of("0123456789") !=
+                             std::string::npos)
+        throw std::runtime_error(option + " expects a number between " +
+                                 range + ", got " + value);
+    size_t count = 0;
+    try {
+        count = std::stoul(value);
+    } catch (const std::out_of_range &) {
+        count = hi + 1;
+    }
+    if (count < lo || count > hi)
+        throw std::runtime_error(option + " must be between " + range +
+                                 ", got " + value);
+    return count;
+}
+
+VkPresentModeKHR parsePresentMode(const std::string &name) {
+    if (name == "fifo")
+        return VK_PRESENT_MODE_FIFO_KHR;
+    if (name == "fifo-relaxed")
+        return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    if (name == "mailbox")
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    if (name == "immediate")
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    throw std::runtime_error("Unknown present mode: " + name +
+                             " (expected fifo, fifo-relaxed, mailbox or "
+                             "immediate)");
+}
+
+void parseResolution(const std::string &value, uint32_t &width,
+                     uint32_t &height) {
+    size_t x = value.find('x');
+    if (x == std::string::npos)
+        throw std::runtime_error("Expected WIDTHxHEIGHT, got " + value);
+    width = static_cast<uint32_t>(std::stoul(value.substr(0, x)));
+    height = static_cast<uint32_t>(std::stoul(value.substr(x + 1)));
+    if (width == 0 || height == 0)
+        throw std::runtime_error("Resolution must be non-zero: " + value);
+}
+} // namespace
+
+const char *presentModeName(VkPresentModeKHR mode) {
+    switch (mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo-relaxed";
+    default:
+        return "unknown";
+    }
+}
+
+LaunchOptions LaunchOptions::parse(int argc, char **argv) {
+    LaunchOptions options{};
+    options.framesInFlight = engine::world::FRAMES_IN_FLIGHT;
+    options.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    options.targetFps = engine::world::TARGET_FPS;
+    options.width = 1280;
+    options.height = 720;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--frames-in-flight") {
+            options.framesInFlight =
+                parseCount(arg, value(), 1,
+                           RendererContext::MAX_FRAMES_IN_FLIGHT);
+        } else if (arg == "--present-mode") {
+            options.presentMode = parsePresentMode(value());
+        } else if (arg == "--fps-cap") {
+            options.targetFps = std::stod(value());
+        } else if (arg == "--uncapped") {
+            // Throughput measurement: nothing throttles the loop.
+            options.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            options.targetFps = 0.0;
+        } else if (arg == "--low-latency") {
+            // Interactive use: one frame queued, newest image wins.
+            options.framesInFlight = 1;
+            options.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        } else if (arg == "--resolution") {
+            parseResolution(value(), options.width, options.height);
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--camera-path") {
+            options.cameraPath = value();
+        } else if (arg == "--report") {
+            options.reportPath = value();
+        } else if (arg == "--lockstep") {
+            options.lockstep = true;
+        } else if (arg == "--record-path") {
+            options.recordPath = value();
+        } else if (arg == "--bench-meshing") {
+            options.benchMeshing =
+                parseCount(arg, value(), 1, std::numeric_limits<int>::max());
+        } else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (options.headless && options.cameraPath.empty())
+        throw std::runtime_error("--headless needs --camera-path");
+    if (!options.recordPath.empty() && !options.cameraPath.empty())
+        throw std::runtime_error(
+            "--record-path and --camera-path are exclusive");
+    return options;
+}
@@ -0,0 +1,63 @@
+#include "engine/core/MeshingBenchmark.hpp"
+#include "engine/voxel/VoxelMesher.hpp"
+#include "engine/world/Config.hpp"
+#include "engine/world/TerrainGenerator.hpp"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace engine::voxel;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+/// Chunk origins of a square patch around spawn.
+std::vector<glm::ivec3> chunkOrigins(size_t chunks) {
+    const int side = int(std::ceil(std::sqrt(double(chunks))));
+    std::vector<glm::ivec3> origins;
+    for (size_t i = 0; i < chunks; ++i) {
+        const int cx = int(i) % side - side / 2;
+        const int cz = int(i) / side - side / 2;
+        origins.push_back({cx * engine::world::CHUNK_DIM.x, 0,
+                           cz * engine::world::CHUNK_DIM.z});
+    }
+    return origins;
+}
+
+template <typename Layout>
+void runLayout(const std::vector<glm::ivec3> &origins, std::ostream &out) {
+    std::vector<BasicVoxelVolume<Layout>> volumes;
+    volumes.reserve(origins.size());
+    const Clock::time_point genStart = Clock::now();
+    for (const glm::ivec3 &origin : origins) {
+        volumes.emplace_back(engine::world::CHUNK_DIM);
+        engine::world::TerrainGenerator::Generate(volumes.back(), origin);
+    }
+    const double genMs = msSince(genStart);
+
+    MeshTimings timings;
+    size_t indices = 0;
+    for (const BasicVoxelVolume<Layout> &vol : volumes)
+        indices += VoxelMesher::GenerateMesh(vol, 1, &timings)->indexCount();
+
+    const double n = double(origins.size());
+    const double *axis = timings.axisMs;
+    out << "  " << Layout::NAME << "\tgen " << genMs / n << "  x "
+        << axis[0] / n << "  y " << axis[1] / n << "  z " << axis[2] / n
+        << "  mesh " << (axis[0] + axis[1] + axis[2]) / n << "  tris "
+        << indices / 3 << "\n";
+}
+} // namespace
+
+void MeshingBenchmark::Run(size_t chunks, std::ostream &out) {
+    const std::vector<glm::ivec3> origins = chunkOrigins(chunks);
+    out << "meshing benchmark: " << chunks << " chunks, ms per chunk\n";
+    runLayout<LinearLayout>(origins, out);
+    runLayout<Brick4Layout>(origins, out);
+    runLayout<MortonLayout>(origins, out);
+}
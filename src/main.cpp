@@ -1,7 +1,23 @@
 #include "engine/core/Application.hpp"
+#include "engine/core/MeshingBenchmark.hpp"
+#include <exception>
+#include <iostream>
 
-int main() {
-    Application app;
+int main(int argc, char **argv) {
+    LaunchOptions options;
+    try {
+        options = LaunchOptions::parse(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (options.benchMeshing > 0) {
+        MeshingBenchmark::Run(options.benchMeshing, std::cout);
+        return 0;
+    }
+
+    Application app(options);
     app.Run();
     return 0;
 }
@@ -1,6 +1,22 @@
 
 #include "engine/math/FrustumCulling.hpp"
+#include <algorithm>
+#include <cassert>
 #include <glm/gtc/matrix_access.hpp>
+
+// SSE2 is baseline on x86-64. AVX is compiled per function and picked at
+// runtime, so the binary still runs on CPUs without it.
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CULL_SIMD 1
+#if defined(__AVX__)
+#define CULL_AVX 1
+#define CULL_TARGET_AVX
+#elif defined(__GNUC__)
+#define CULL_AVX 1
+#define CULL_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
 using namespace engine::math;
 
 glm::vec4 FrustumCuller::normalizePlane(const glm::vec4 &p) {
@@ -31,3 +47,146 @@ bool FrustumCuller::isBoxVisible(const glm::vec3 &mn,
     }
     return true;
 }
+
+void AabbSoA::clear() {
+    for (auto *v : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+        v->clear();
+}
+
+void AabbSoA::reserve(size_t count) {
+    for (auto *v : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+        v->reserve(count);
+}
+
+void AabbSoA::push(const glm::vec3 &mn, const glm::vec3 &mx) {
+    minX.push_back(mn.x);
+    minY.push_back(mn.y);
+    minZ.push_back(mn.z);
+    maxX.push_back(mx.x);
+    maxY.push_back(mx.y);
+    maxZ.push_back(mx.z);
+}
+
+namespace {
+
+/// One plane with its positive vertex already chosen: the plane is the
+/// same for every box, so picking min or max per axis is done once here
+/// instead of per box.
+struct PlaneRef {
+    const float *x, *y, *z;
+    float a, b, c, d;
+};
+
+bool visibleScalar(const PlaneRef *planes, size_t i) {
+    for (int p = 0; p < 6; ++p) {
+        const PlaneRef &pl = planes[p];
+        if (pl.a * pl.x[i] + pl.b * pl.y[i] + pl.c * pl.z[i] + pl.d < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+#if CULL_SIMD
+size_t cullSse(const PlaneRef *planes, size_t i, size_t last,
+               uint64_t *mask) {
+    __m128 a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; ++p) {
+        a[p] = _mm_set1_ps(planes[p].a);
+        b[p] = _mm_set1_ps(planes[p].b);
+        c[p] = _mm_set1_ps(planes[p].c);
+        d[p] = _mm_set1_ps(planes[p].d);
+    }
+    for (; i + 4 <= last; i += 4) {
+        __m128 vis = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 x = _mm_mul_ps(a[p], _mm_loadu_ps(planes[p].x + i));
+            __m128 y = _mm_mul_ps(b[p], _mm_loadu_ps(planes[p].y + i));
+            __m128 z = _mm_mul_ps(c[p], _mm_loadu_ps(planes[p].z + i));
+            __m128 dist = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, d[p]));
+            // Not-less-than, so NaN counts as visible like the scalar test.
+            vis = _mm_and_ps(vis, _mm_cmpnlt_ps(dist, _mm_setzero_ps()));
+        }
+        mask[i >> 6] |= uint64_t(_mm_movemask_ps(vis)) << (i & 63);
+    }
+    return i;
+}
+#endif
+
+#if CULL_AVX
+CULL_TARGET_AVX size_t cullAvx(const PlaneRef *planes, size_t i, size_t last,
+                               uint64_t *mask) {
+    __m256 a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; ++p) {
+        a[p] = _mm256_set1_ps(planes[p].a);
+        b[p] = _mm256_set1_ps(planes[p].b);
+        c[p] = _mm256_set1_ps(planes[p].c);
+        d[p] = _mm256_set1_ps(planes[p].d);
+    }
+    for (; i + 8 <= last; i += 8) {
+        __m256 vis = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 x = _mm256_mul_ps(a[p], _mm256_loadu_ps(planes[p].x + i));
+            __m256 y = _mm256_mul_ps(b[p], _mm256_loadu_ps(planes[p].y + i));
+            __m256 z = _mm256_mul_ps(c[p], _mm256_loadu_ps(planes[p].z + i));
+            __m256 dist =
+                _mm256_add_ps(_mm256_add_ps(x, y), _mm256_add_ps(z, d[p]));
+            vis = _mm256_and_ps(
+                vis, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_NLT_UQ));
+        }
+        mask[i >> 6] |= uint64_t(_mm256_movemask_ps(vis)) << (i & 63);
+    }
+    return i;
+}
+
+bool cpuHasAvx() {
+#if defined(__AVX__)
+    return true;
+#else
+    static const bool has = __builtin_cpu_supports("avx");
+    return has;
+#endif
+}
+#endif
+
+} // namespace
+
+void FrustumCuller::cullBoxes(const AabbSoA &boxes, size_t first, size_t last,
+                              uint64_t *mask) const {
+    assert(first % 64 == 0);
+    last = std::min(last, boxes.size());
+    if (first >= last)
+        return;
+    std::fill(mask + first / 64, mask + (last + 63) / 64, uint64_t(0));
+
+    PlaneRef refs[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4 &pl = planes[p];
+        refs[p] = {pl.x >= 0 ? boxes.maxX.data() : boxes.minX.data(),
+                   pl.y >= 0 ? boxes.maxY.data() : boxes.minY.data(),
+                   pl.z >= 0 ? boxes.maxZ.data() : boxes.minZ.data(),
+                   pl.x,
+                   pl.y,
+                   pl.z,
+                   pl.w};
+    }
+
+    // Blocks of 8 then 4 never straddle a mask word, since `first` is
+    // word-aligned; the scalar loop picks up the tail.
+    size_t i = first;
+#if CULL_AVX
+    if (cpuHasAvx())
+        i = cullAvx(refs, i, last, mask);
+#endif
+#if CULL_SIMD
+    i = cullSse(refs, i, last, mask);
+#endif
+    for (; i < last; ++i)
+        if (visibleScalar(refs, i))
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+}
+
+void FrustumCuller::cullBoxes(const AabbSoA &boxes,
+                              std::vector<uint64_t> &mask) const {
+    mask.assign((boxes.size() + 63) / 64, 0);
+    cullBoxes(boxes, 0, boxes.size(), mask.data());
+}
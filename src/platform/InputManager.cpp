@@ -58,6 +58,6 @@ void InputManager::processInput(float dt) {
 
     if (glm::length(delta) > 0.001f) {
         delta = glm::normalize(delta) * speed * dt;
-        cam_.setPosition(cam_.getPosition() + delta);
+        cam_.setPosition(cam_.getPosition() + glm::dvec3(delta));
     }
 }
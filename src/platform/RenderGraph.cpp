@@ -1,109 +1,489 @@
-
-
 #include "engine/platform/RenderGraph.hpp"
-#include "engine/platform/RenderCommandManager.hpp"
-#include "engine/platform/RenderResources.hpp"
-#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <stdexcept>
 
-void RenderGraph::beginFrame(RenderResources &resources,
-                             RenderCommandManager &commandManager,
-                             size_t frameIndex, uint32_t imageIndex,
-                             const glm::mat4 &viewProj, VkImage swapchainImage,
-                             VkImageLayout currentLayout) {
-
-    resources.updateUniforms(frameIndex, viewProj);
-    commandBuffer_ = commandManager.get(frameIndex);
-    swapchainImage_ = swapchainImage;
-
-    VkCommandBufferBeginInfo beginInfo{
-        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    if (vkBeginCommandBuffer(commandBuffer_, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to begin command buffer");
-    }
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = currentLayout;
-    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    barrier.image = swapchainImage_;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    vkCmdPipelineBarrier(commandBuffer_, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0,
-                         nullptr, 0, nullptr, 1, &barrier);
-
-    VkClearValue clears[2] = {};
-    clears[0].color = {{0.1f, 0.1f, 0.1f, 1.0f}};
-    clears[1].depthStencil = {1.0f, 0};
-
-    VkRenderPassBeginInfo rpBeginInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    rpBeginInfo.renderPass = resources.getRenderPass();
-
-    rpBeginInfo.framebuffer = resources.getFramebuffers()[imageIndex];
-    rpBeginInfo.renderArea = {{0, 0}, resources.getSwapchain()->getExtent()};
-    rpBeginInfo.clearValueCount = 2;
-    rpBeginInfo.pClearValues = clears;
-
-    vkCmdBeginRenderPass(commandBuffer_, &rpBeginInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
-
-    const auto &pipeline = resources.getPipeline();
-    vkCmdBindPipeline(commandBuffer_, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      pipeline.pipeline);
-
-    uint32_t dynOffset = static_cast<uint32_t>(sizeof(glm::mat4) * frameIndex);
-    vkCmdBindDescriptorSets(commandBuffer_, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            pipeline.layout, 0, 1,
-                            &resources.getDescriptorSets()[0], 1, &dynOffset);
-
-    VkViewport viewport = {
-        0.f,
-        0.f,
-        static_cast<float>(resources.getSwapchain()->getExtent().width),
-        static_cast<float>(resources.getSwapchain()->getExtent().height),
-        0.f,
-        1.f};
-    VkRect2D scissor = {{0, 0}, resources.getSwapchain()->getExtent()};
-
-    vkCmdSetViewport(commandBuffer_, 0, 1, &viewport);
-    vkCmdSetScissor(commandBuffer_, 0, 1, &scissor);
-
-    finalLayout_ = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-}
-
-void RenderGraph::endFrame() {
-    vkCmdEndRenderPass(commandBuffer_);
-
-    VkImageMemoryBarrier presentBarrier{};
-    presentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    presentBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    presentBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    presentBarrier.dstAccessMask = 0;
-    presentBarrier.image = swapchainImage_;
-    presentBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    presentBarrier.subresourceRange.baseMipLevel = 0;
-    presentBarrier.subresourceRange.levelCount = 1;
-    presentBarrier.subresourceRange.baseArrayLayer = 0;
-    presentBarrier.subresourceRange.layerCount = 1;
-
-    vkCmdPipelineBarrier(commandBuffer_,
-                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0,
-                         nullptr, 1, &presentBarrier);
-
-    if (vkEndCommandBuffer(commandBuffer_) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to end command buffer");
-    }
-
-    finalLayout_ = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+namespace {
+
+struct Usage {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    VkImageLayout layout;
+};
+
+Usage usageFor(RenderGraph::Access access, bool write,
+               RenderGraph::PassType type) {
+    using Access = RenderGraph::Access;
+    const VkPipelineStageFlags2 shaderStages =
+        type == RenderGraph::PassType::Compute
+            ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+            : VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+                  VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    const VkPipelineStageFlags2 depthStages =
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT |
+        VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+    switch (access) {
+    case Access::ColorAttachment:
+        return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                write ? VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+                      : VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    case Access::DepthAttachment:
+        return {depthStages,
+                write ? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                      : VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                write ? VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
+                      : VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL};
+    case Access::Sampled:
+        return {shaderStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    case Access::Storage:
+        return {shaderStages,
+                write ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+                      : VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                VK_IMAGE_LAYOUT_GENERAL};
+    case Access::TransferSrc:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                VK_ACCESS_2_TRANSFER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+    case Access::TransferDst:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    case Access::Indirect:
+        return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED};
+    case Access::Vertex:
+        return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+                VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT |
+                    VK_ACCESS_2_INDEX_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED};
+    }
+    throw std::runtime_error("Unknown render graph access");
+}
+
+VkImageUsageFlags imageUsageFor(RenderGraph::Access access) {
+    using Access = RenderGraph::Access;
+    switch (access) {
+    case Access::ColorAttachment:
+        return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    case Access::DepthAttachment:
+        return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    case Access::Sampled:
+        return VK_IMAGE_USAGE_SAMPLED_BIT;
+    case Access::Storage:
+        return VK_IMAGE_USAGE_STORAGE_BIT;
+    case Access::TransferSrc:
+        return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    case Access::TransferDst:
+        return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    default:
+        return 0;
+    }
+}
+
+VkAttachmentLoadOp toVk(RenderGraph::LoadOp op) {
+    switch (op) {
+    case RenderGraph::LoadOp::Clear:
+        return VK_ATTACHMENT_LOAD_OP_CLEAR;
+    case RenderGraph::LoadOp::DontCare:
+        return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    default:
+        return VK_ATTACHMENT_LOAD_OP_LOAD;
+    }
+}
+
+} // namespace
+
+void RenderGraph::PassBuilder::read(ResourceId id, Access access) {
+    graph_.passes_[pass_].accesses.push_back(
+        {id, access, false, LoadOp::Load, {}});
+    graph_.resources_[id].usage |= imageUsageFor(access);
+}
+
+void RenderGraph::PassBuilder::write(ResourceId id, Access access, LoadOp load,
+                                     VkClearValue clear) {
+    graph_.passes_[pass_].accesses.push_back({id, access, true, load, clear});
+    graph_.resources_[id].usage |= imageUsageFor(access);
+}
+
+void RenderGraph::PassBuilder::useSecondaryCommandBuffers() {
+    graph_.passes_[pass_].secondary = true;
+}
+
+void RenderGraph::init(VkDevice device, VmaAllocator allocator) {
+    device_ = device;
+    allocator_ = allocator;
+}
+
+void RenderGraph::cleanup() {
+    destroyTransients();
+    resources_.clear();
+    passes_.clear();
+    compiled_ = false;
+}
+
+RenderGraph::ResourceId RenderGraph::importImage(const std::string &name,
+                                                 VkImageAspectFlags aspect,
+                                                 VkImageLayout finalLayout) {
+    Resource res;
+    res.name = name;
+    res.imported = true;
+    res.desc.aspect = aspect;
+    res.finalLayout = finalLayout;
+    resources_.push_back(res);
+    return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::importBuffer(const std::string &name) {
+    Resource res;
+    res.name = name;
+    res.imported = true;
+    res.isBuffer = true;
+    resources_.push_back(res);
+    return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::createImage(const std::string &name,
+                                                 const ImageDesc &desc) {
+    Resource res;
+    res.name = name;
+    res.desc = desc;
+    resources_.push_back(res);
+    compiled_ = false;
+    return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+void RenderGraph::setImportedImage(ResourceId id, VkImage image,
+                                   VkImageView view) {
+    resources_[id].image = image;
+    resources_[id].view = view;
+    resources_[id].extent = extent_;
+}
+
+void RenderGraph::setImportedBuffer(ResourceId id, VkBuffer buffer) {
+    resources_[id].buffer = buffer;
+}
+
+void RenderGraph::addPass(const std::string &name, PassType type,
+                          const SetupFn &setup, ExecuteFn execute) {
+    passes_.push_back({name, type, std::move(execute), {}});
+    PassBuilder builder(*this, passes_.size() - 1);
+    setup(builder);
+    compiled_ = false;
+}
+
+void RenderGraph::resize(VkExtent2D extent) {
+    if (extent.width == extent_.width && extent.height == extent_.height)
+        return;
+    extent_ = extent;
+    compiled_ = false;
+}
+
+VkImageView RenderGraph::getImageView(ResourceId id) const {
+    return resources_[id].view;
+}
+
+void RenderGraph::destroyTransients() {
+    for (auto &res : resources_) {
+        if (res.imported)
+            continue;
+        if (res.view != VK_NULL_HANDLE)
+            vkDestroyImageView(device_, res.view, nullptr);
+        if (res.image != VK_NULL_HANDLE)
+            vkDestroyImage(device_, res.image, nullptr);
+        res.view = VK_NULL_HANDLE;
+        res.image = VK_NULL_HANDLE;
+        res.slot = -1;
+    }
+    for (auto &slot : slots_)
+        vmaFreeMemory(allocator_, slot.allocation);
+    slots_.clear();
+    transientBytes_ = 0;
+    aliasedBytes_ = 0;
+}
+
+void RenderGraph::compile() {
+    destroyTransients();
+
+    // Cull back to front: a pass survives if it writes something that is
+    // imported or read by a surviving later pass.
+    std::vector<bool> needed(resources_.size());
+    for (size_t i = 0; i < resources_.size(); ++i)
+        needed[i] = resources_[i].imported;
+    for (size_t i = passes_.size(); i-- > 0;) {
+        Pass &pass = passes_[i];
+        pass.culled = true;
+        for (const auto &decl : pass.accesses)
+            if (decl.write && needed[decl.resource])
+                pass.culled = false;
+        if (pass.culled)
+            continue;
+        for (const auto &decl : pass.accesses)
+            if (!decl.write || decl.load == LoadOp::Load)
+                needed[decl.resource] = true;
+    }
+
+    for (auto &res : resources_) {
+        res.firstPass = -1;
+        res.lastPass = -1;
+    }
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        if (passes_[i].culled)
+            continue;
+        for (const auto &decl : passes_[i].accesses) {
+            Resource &res = resources_[decl.resource];
+            if (res.firstPass < 0)
+                res.firstPass = int(i);
+            res.lastPass = int(i);
+        }
+    }
+
+    // Greedy interval packing: each transient reuses the first slot whose
+    // previous occupant is dead by the time it is first written.
+    std::vector<size_t> order;
+    for (size_t i = 0; i < resources_.size(); ++i)
+        if (!resources_[i].imported && resources_[i].firstPass >= 0)
+            order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return resources_[a].firstPass < resources_[b].firstPass;
+    });
+
+    for (size_t idx : order) {
+        Resource &res = resources_[idx];
+        res.extent = {
+            std::max(1u, uint32_t(float(extent_.width) * res.desc.scale)),
+            std::max(1u, uint32_t(float(extent_.height) * res.desc.scale))};
+
+        VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ici.imageType = VK_IMAGE_TYPE_2D;
+        ici.format = res.desc.format;
+        ici.extent = {res.extent.width, res.extent.height, 1};
+        ici.mipLevels = 1;
+        ici.arrayLayers = 1;
+        ici.samples = VK_SAMPLE_COUNT_1_BIT;
+        ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ici.usage = res.usage;
+        ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(device_, &ici, nullptr, &res.image) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create transient image " +
+                                     res.name);
+
+        VkMemoryRequirements reqs;
+        vkGetImageMemoryRequirements(device_, res.image, &reqs);
+        transientBytes_ += reqs.size;
+
+        for (size_t s = 0; s < slots_.size(); ++s) {
+            AliasSlot &slot = slots_[s];
+            if (slot.lastPass >= res.firstPass ||
+                !(slot.reqs.memoryTypeBits & reqs.memoryTypeBits))
+                continue;
+            slot.reqs.size = std::max(slot.reqs.size, reqs.size);
+            slot.reqs.alignment = std::max(slot.reqs.alignment, reqs.alignment);
+            slot.reqs.memoryTypeBits &= reqs.memoryTypeBits;
+            slot.lastPass = res.lastPass;
+            res.slot = int(s);
+            break;
+        }
+        if (res.slot < 0) {
+            slots_.push_back({reqs, res.lastPass, VK_NULL_HANDLE});
+            res.slot = int(slots_.size() - 1);
+        }
+    }
+
+    size_t slotBytes = 0;
+    for (auto &slot : slots_) {
+        VmaAllocationCreateInfo aci{};
+        aci.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (vmaAllocateMemory(allocator_, &slot.reqs, &aci, &slot.allocation,
+                              nullptr) != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate transient memory");
+        slotBytes += slot.reqs.size;
+    }
+    aliasedBytes_ = transientBytes_ - slotBytes;
+
+    for (size_t idx : order) {
+        Resource &res = resources_[idx];
+        vmaBindImageMemory(allocator_, slots_[res.slot].allocation, res.image);
+
+        VkImageViewCreateInfo vci{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vci.image = res.image;
+        vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vci.format = res.desc.format;
+        vci.subresourceRange = {res.desc.aspect, 0, 1, 0, 1};
+        if (vkCreateImageView(device_, &vci, nullptr, &res.view) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create transient view " +
+                                     res.name);
+    }
+
+    compiled_ = true;
+}
+
+void RenderGraph::transition(Resource &res, const Pass &pass,
+                             const AccessDecl &decl,
+                             std::vector<VkImageMemoryBarrier2> &images,
+                             std::vector<VkBufferMemoryBarrier2> &buffers) {
+    Usage use = usageFor(decl.access, decl.write, pass.type);
+    State &state = res.state;
+
+    // Read after read in the same layout needs no barrier; just widen the
+    // set of stages a later writer has to wait for.
+    bool layoutChange = !res.isBuffer && state.layout != use.layout;
+    if (!layoutChange && !state.write && !decl.write) {
+        state.stages |= use.stages;
+        state.access |= use.access;
+        return;
+    }
+
+    VkAccessFlags2 srcAccess = state.write ? state.access : 0;
+    if (res.isBuffer) {
+        VkBufferMemoryBarrier2 b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+        b.srcStageMask = state.stages;
+        b.srcAccessMask = srcAccess;
+        b.dstStageMask = use.stages;
+        b.dstAccessMask = use.access;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.buffer = res.buffer;
+        b.size = VK_WHOLE_SIZE;
+        buffers.push_back(b);
+    } else {
+        VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        b.srcStageMask = state.stages;
+        b.srcAccessMask = srcAccess;
+        b.dstStageMask = use.stages;
+        b.dstAccessMask = use.access;
+        b.oldLayout = state.layout;
+        b.newLayout = use.layout;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.image = res.image;
+        b.subresourceRange = {res.desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0,
+                              VK_REMAINING_ARRAY_LAYERS};
+        images.push_back(b);
+    }
+    state = {use.layout, use.stages, use.access, decl.write};
+}
+
+void RenderGraph::recordRendering(VkCommandBuffer cmd, const Pass &pass) {
+    std::vector<VkRenderingAttachmentInfo> colors;
+    VkRenderingAttachmentInfo depth{
+        VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
+    bool hasDepth = false;
+    VkExtent2D area = extent_;
+    int passIndex = int(&pass - passes_.data());
+
+    for (const auto &decl : pass.accesses) {
+        if (decl.access != Access::ColorAttachment &&
+            decl.access != Access::DepthAttachment)
+            continue;
+        const Resource &res = resources_[decl.resource];
+        area = res.extent;
+
+        VkRenderingAttachmentInfo info{
+            VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
+        info.imageView = res.view;
+        info.imageLayout = res.state.layout;
+        info.loadOp = decl.write ? toVk(decl.load) : VK_ATTACHMENT_LOAD_OP_LOAD;
+        // Transients are not needed past their last reader.
+        info.storeOp = !res.imported && res.lastPass == passIndex
+                           ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                           : VK_ATTACHMENT_STORE_OP_STORE;
+        info.clearValue = decl.clear;
+
+        if (decl.access == Access::ColorAttachment) {
+            colors.push_back(info);
+        } else {
+            depth = info;
+            hasDepth = true;
+        }
+    }
+
+    VkRenderingInfo ri{VK_STRUCTURE_TYPE_RENDERING_INFO};
+    if (pass.secondary)
+        ri.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    ri.renderArea = {{0, 0}, area};
+    ri.layerCount = 1;
+    ri.colorAttachmentCount = static_cast<uint32_t>(colors.size());
+    ri.pColorAttachments = colors.data();
+    ri.pDepthAttachment = hasDepth ? &depth : nullptr;
+    vkCmdBeginRendering(cmd, &ri);
+
+    if (!pass.secondary) {
+        VkViewport viewport = {
+            0.f, 0.f, float(area.width), float(area.height), 0.f, 1.f};
+        VkRect2D scissor = {{0, 0}, area};
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+    }
+
+    pass.execute(cmd);
+
+    vkCmdEndRendering(cmd);
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd) {
+    if (!compiled_)
+        compile();
+
+    for (auto &res : resources_)
+        res.state = State{};
+
+    std::vector<VkImageMemoryBarrier2> images;
+    std::vector<VkBufferMemoryBarrier2> buffers;
+    auto flushBarriers = [&]() {
+        if (images.empty() && buffers.empty())
+            return;
+        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        dep.imageMemoryBarrierCount = static_cast<uint32_t>(images.size());
+        dep.pImageMemoryBarriers = images.data();
+        dep.bufferMemoryBarrierCount = static_cast<uint32_t>(buffers.size());
+        dep.pBufferMemoryBarriers = buffers.data();
+        vkCmdPipelineBarrier2(cmd, &dep);
+        images.clear();
+        buffers.clear();
+    };
+
+    for (const auto &pass : passes_) {
+        if (pass.culled)
+            continue;
+
+        bool hasAttachments = false;
+        for (const auto &decl : pass.accesses) {
+            transition(resources_[decl.resource], pass, decl, images, buffers);
+            hasAttachments |= decl.access == Access::ColorAttachment ||
+                              decl.access == Access::DepthAttachment;
+        }
+        flushBarriers();
+
+        if (pass.type == PassType::Graphics && hasAttachments)
+            recordRendering(cmd, pass);
+        else
+            pass.execute(cmd);
+    }
+
+    for (auto &res : resources_) {
+        if (!res.imported || res.isBuffer ||
+            res.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            res.finalLayout == res.state.layout)
+            continue;
+        VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        b.srcStageMask = res.state.stages;
+        b.srcAccessMask = res.state.write ? res.state.access : 0;
+        b.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        b.oldLayout = res.state.layout;
+        b.newLayout = res.finalLayout;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.image = res.image;
+        b.subresourceRange = {res.desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0,
+                              VK_REMAINING_ARRAY_LAYERS};
+        images.push_back(b);
+        res.state.layout = res.finalLayout;
+    }
+    flushBarriers();
 }
@@ -1,70 +1,63 @@
 #include "engine/platform/RenderResources.hpp"
+#include "engine/world/Config.hpp"
+#include "engine/world/WorldCoords.hpp"
 #include <string>
 
-void RenderResources::init(VulkanDevice *device, Swapchain *swapchain) {
+static constexpr const char *PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+
+void RenderResources::init(VulkanDevice *device, Swapchain *swapchain,
+                           size_t framesInFlight) {
     device_ = device;
     swapchain_ = swapchain;
     allocator_ = device_->getAllocator();
 
-    VkExtent2D extent = swapchain_->getExtent();
-    VkFormat colorFormat = swapchain_->getImageFormat();
-
-    depth_.init(device_->getDevice(), allocator_, device_->getPhysicalDevice(),
-                extent, VK_FORMAT_D32_SFLOAT);
+    colorFormat_ = swapchain_->getImageFormat();
 
-    renderPass_.init(device_->getDevice(), colorFormat, depth_.format());
+    uniforms_.init(device_->getDevice(), device_->getPhysicalDevice(),
+                   allocator_, framesInFlight,
+                   engine::world::UNIFORM_RING_BYTES_PER_FRAME,
+                   sizeof(CameraUniforms));
 
-    uniforms_.init(device_->getDevice(), allocator_, 2);
-
-    pipeline_.init(device_->getDevice(), renderPass_.get(), uniforms_.layout(),
-                   std::string(SPIRV_OUT) + "/vert.spv",
-                   std::string(SPIRV_OUT) + "/frag.spv");
+    pipelineCache_.init(device_->getDevice(), device_->getPhysicalDevice(),
+                        PIPELINE_CACHE_FILE);
+    createPipeline();
+}
 
-    framebuffers_.init(device_->getDevice(), renderPass_.get(), extent,
-                       swapchain_->getImageViews(), depth_.view());
+void RenderResources::createPipeline() {
+    pipeline_.init(device_->getDevice(), colorFormat_, getDepthFormat(),
+                   uniforms_.layout(), std::string(SPIRV_OUT) + "/vert.spv",
+                   std::string(SPIRV_OUT) + "/frag.spv", pipelineCache_.get());
 }
 
 void RenderResources::recreate() {
     vkDeviceWaitIdle(device_->getDevice());
 
-    VkExtent2D extent = swapchain_->getExtent();
-
-    depth_.cleanup(device_->getDevice(), allocator_);
-    depth_.init(device_->getDevice(), allocator_, device_->getPhysicalDevice(),
-                extent, VK_FORMAT_D32_SFLOAT);
-
-    renderPass_.cleanup(device_->getDevice());
-    renderPass_.init(device_->getDevice(), swapchain_->getImageFormat(),
-                     depth_.format());
-
-    pipeline_.cleanup(device_->getDevice());
-    pipeline_.init(device_->getDevice(), renderPass_.get(), uniforms_.layout(),
-                   std::string(SPIRV_OUT) + "/vert.spv",
-                   std::string(SPIRV_OUT) + "/frag.spv");
-
-    framebuffers_.cleanup(device_->getDevice());
-    framebuffers_.init(device_->getDevice(), renderPass_.get(), extent,
-                       swapchain_->getImageViews(), depth_.view());
+    // With dynamic rendering and dynamic viewport/scissor the pipeline only
+    // depends on attachment formats; sized images belong to the render graph.
+    VkFormat colorFormat = swapchain_->getImageFormat();
+    if (colorFormat != colorFormat_) {
+        colorFormat_ = colorFormat;
+        pipeline_.cleanup(device_->getDevice());
+        createPipeline();
+    }
 }
 
 void RenderResources::cleanup() {
-    framebuffers_.cleanup(device_->getDevice());
-    renderPass_.cleanup(device_->getDevice());
-    depth_.cleanup(device_->getDevice(), allocator_);
     uniforms_.cleanup(device_->getDevice(), allocator_);
     pipeline_.cleanup(device_->getDevice());
+    pipelineCache_.cleanup(device_->getDevice());
 }
 
 const engine::render::Pipeline &RenderResources::getPipeline() const {
     return pipeline_;
 }
 
-VkRenderPass RenderResources::getRenderPass() const {
-    return renderPass_.get();
-}
+void RenderResources::bindPipeline(VkCommandBuffer cmd) const {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_.pipeline);
 
-const std::vector<VkFramebuffer> &RenderResources::getFramebuffers() const {
-    return framebuffers_.get();
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            pipeline_.layout, 0, 1, &uniforms_.sets()[0], 1,
+                            &cameraOffset_);
 }
 
 const std::vector<VkDescriptorSet> &RenderResources::getDescriptorSets() const {
@@ -78,8 +71,16 @@ VkDescriptorSetLayout RenderResources::getDescriptorSetLayout() const {
 Swapchain *RenderResources::getSwapchain() const { return swapchain_; }
 
 void RenderResources::updateUniforms(size_t frameIndex,
-                                     const glm::mat4 &viewProj) {
-    uniforms_.update(allocator_, frameIndex, viewProj);
+                                     const engine::render::Camera &camera) {
+    using namespace engine::world;
+    const CameraAnchor anchor = anchorOf(camera.getPosition());
+    CameraUniforms block{camera.relativeViewProjection(),
+                         glm::ivec4(anchor.chunk.x, 0, anchor.chunk.y, 0),
+                         glm::vec4(anchor.offset, 0.0f),
+                         glm::ivec4(CHUNK_DIM, 0)};
+
+    uniforms_.beginFrame(frameIndex);
+    cameraOffset_ = uniforms_.push(block);
 }
 
 VmaAllocator RenderResources::getAllocator() const { return allocator_; }
@@ -3,25 +3,76 @@
 #include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 #include <stdexcept>
+#include <string>
 #define VMA_IMPLEMENTATION
 #include "externals/vk_mem_alloc.h"
 #define IMGUI_IMPL_VULKAN_NO_PROTOTYPES
 
-using engine::world::DEBUG;
+using engine::world::RECORD_THREADS;
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_vulkan.h>
 #include <imgui.h>
 
-RendererContext::RendererContext(GLFWwindow *window)
-    : cam_(glm::radians(45.0f), 1280.f / 720.f, 0.1f, 1000.0f) {
-    init(window);
+RendererContext::RendererContext(GLFWwindow *window, VkExtent2D extent,
+                                 size_t framesInFlight,
+                                 VkPresentModeKHR presentMode)
+    : framesInFlight_(framesInFlight), presentMode_(presentMode),
+      cam_(glm::radians(45.0f), float(extent.width) / float(extent.height),
+           0.1f, 2500.0f) {
+    init(window, extent);
+}
+
+RendererContext::~RendererContext() {
+    vkDestroyQueryPool(device_->getDevice(), pipelineStatsQueryPool_, nullptr);
+    vkDestroyQueryPool(device_->getDevice(), occlusionQueryPool_, nullptr);
+    vkDestroyQueryPool(device_->getDevice(), timestampQueryPool_, nullptr);
+
+    cleanup();
+}
+
+void RendererContext::init(GLFWwindow *window, VkExtent2D extent) {
+    if (framesInFlight_ < 1 || framesInFlight_ > MAX_FRAMES_IN_FLIGHT)
+        throw std::runtime_error("Frames in flight must be between 1 and " +
+                                 std::to_string(MAX_FRAMES_IN_FLIGHT));
+    frameStats_.resize(framesInFlight_);
+
+    device_ = std::make_unique<VulkanDevice>(window);
+    if (window)
+        swapchain_ = std::make_unique<Swapchain>(
+            device_.get(), device_->getSurface(), window, framesInFlight_,
+            presentMode_);
+    else
+        swapchain_ = std::make_unique<Swapchain>(device_.get(), extent,
+                                                 framesInFlight_);
+    allocator_ = device_->getAllocator();
+
+    frameSync_.init(device_->getDevice(), framesInFlight_);
+    commandManager_.init(device_->getDevice(),
+                         device_->getGraphicsQueueFamilyIndex(),
+                         framesInFlight_);
+    secondaryCommands_.init(device_->getDevice(),
+                            device_->getGraphicsQueueFamilyIndex(),
+                            framesInFlight_, RECORD_THREADS);
+    renderResources_.init(device_.get(), swapchain_.get(), framesInFlight_);
+
+    renderGraph_.init(device_->getDevice(), allocator_);
+    renderGraph_.resize(swapchain_->getExtent());
+    backbuffer_ = renderGraph_.importImage(
+        "backbuffer", VK_IMAGE_ASPECT_COLOR_BIT,
+        swapchain_->isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                  : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    depthTarget_ = renderGraph_.createImage(
+        "depth",
+        {renderResources_.getDepthFormat(), VK_IMAGE_ASPECT_DEPTH_BIT});
 
+    createQueryPools();
+}
+
+void RendererContext::createQueryPools() {
     VkQueryPoolCreateInfo qpci{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
     qpci.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
-    qpci.queryCount = MAX_FRAMES_IN_FLIGHT;
-    qpci.pipelineStatistics =
-        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
-        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT;
+    qpci.queryCount = static_cast<uint32_t>(framesInFlight_);
+    qpci.pipelineStatistics = PIPELINE_STATISTICS;
     if (vkCreateQueryPool(device_->getDevice(), &qpci, nullptr,
                           &pipelineStatsQueryPool_) != VK_SUCCESS) {
         throw std::runtime_error(
@@ -30,78 +81,137 @@ RendererContext::RendererContext(GLFWwindow *window)
 
     VkQueryPoolCreateInfo qpci2{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
     qpci2.queryType = VK_QUERY_TYPE_OCCLUSION;
-    qpci2.queryCount = MAX_FRAMES_IN_FLIGHT;
+    qpci2.queryCount = static_cast<uint32_t>(framesInFlight_);
     if (vkCreateQueryPool(device_->getDevice(), &qpci2, nullptr,
                           &occlusionQueryPool_) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create occlusion query pool");
     }
-}
-
-RendererContext::~RendererContext() {
-    vkDestroyQueryPool(device_->getDevice(), pipelineStatsQueryPool_, nullptr);
-    vkDestroyQueryPool(device_->getDevice(), occlusionQueryPool_, nullptr);
 
-    cleanup();
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(device_->getPhysicalDevice(), &props);
+    if (!props.limits.timestampComputeAndGraphics)
+        return;
+    timestampPeriod_ = props.limits.timestampPeriod;
+    VkQueryPoolCreateInfo qpci3{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qpci3.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qpci3.queryCount = static_cast<uint32_t>(2 * framesInFlight_);
+    if (vkCreateQueryPool(device_->getDevice(), &qpci3, nullptr,
+                          &timestampQueryPool_) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool");
+    }
 }
 
-void RendererContext::init(GLFWwindow *window) {
-    device_ = std::make_unique<VulkanDevice>(window);
-    swapchain_ = std::make_unique<Swapchain>(device_.get(),
-                                             device_->getSurface(), window);
-    allocator_ = device_->getAllocator();
-
-    frameSync_.init(device_->getDevice(), MAX_FRAMES_IN_FLIGHT);
-    commandManager_.init(device_->getDevice(),
-                         device_->getGraphicsQueueFamilyIndex(),
-                         MAX_FRAMES_IN_FLIGHT);
-    renderResources_.init(device_.get(), swapchain_.get());
-}
+void RendererContext::waitForFrame() {
+    if (frameWaited_)
+        return;
+    frameWaited_ = true;
 
-void RendererContext::beginFrame() {
     VkDevice dev = device_->getDevice();
     VkFence fence = frameSync_.getInFlightFence(currentFrame_);
     vkWaitForFences(dev, 1, &fence, VK_TRUE, UINT64_MAX);
-    vkResetFences(dev, 1, &fence);
 
-    if (!firstFrame_) {
-        size_t lastSlot =
-            (currentFrame_ + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+    // The fence covers this slot's previous frame, so its queries are
+    // ready; reading any other slot would stall on a frame still in flight.
+    if (framesSubmitted_ >= framesInFlight_) {
+        size_t slot = currentFrame_;
+        FrameStats &out = frameStats_[slot];
+        out.frame = framesSubmitted_ - framesInFlight_;
+
         uint64_t stats[2] = {};
-        vkGetQueryPoolResults(dev, pipelineStatsQueryPool_, lastSlot, 1,
+        vkGetQueryPoolResults(dev, pipelineStatsQueryPool_, slot, 1,
                               sizeof(stats), stats, sizeof(uint64_t),
                               VK_QUERY_RESULT_64_BIT |
                                   VK_QUERY_RESULT_WAIT_BIT);
-        statsSubmitted_[lastSlot] = stats[0];
-        statsRasterized_[lastSlot] = stats[1];
+        out.submittedTris = stats[0];
+        out.rasterizedTris = stats[1];
 
         vkGetQueryPoolResults(
-            dev, occlusionQueryPool_, lastSlot, 1, sizeof(uint64_t),
-            &statsSamples_[lastSlot], sizeof(uint64_t),
+            dev, occlusionQueryPool_, slot, 1, sizeof(uint64_t),
+            &out.fragments, sizeof(uint64_t),
             VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+        if (timestampQueryPool_ != VK_NULL_HANDLE) {
+            uint64_t ts[2] = {};
+            vkGetQueryPoolResults(dev, timestampQueryPool_, 2 * slot, 2,
+                                  sizeof(ts), ts, sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT |
+                                      VK_QUERY_RESULT_WAIT_BIT);
+            out.gpuMs = double(ts[1] - ts[0]) * timestampPeriod_ * 1e-6;
+        }
+    }
+}
+
+RendererContext::FrameStats RendererContext::retiredFrameStats() const {
+    return frameStats_[currentFrame_];
+}
+
+void RendererContext::beginFrame() {
+    waitForFrame();
+    frameWaited_ = false;
+
+    VkDevice dev = device_->getDevice();
+    if (swapchain_->isOffscreen()) {
+        // One offscreen image per frame slot; the fence wait above already
+        // guarantees it is idle.
+        currentImageIndex_ = static_cast<uint32_t>(currentFrame_);
     } else {
-        firstFrame_ = false;
+        auto acquire = [&]() {
+            return vkAcquireNextImageKHR(
+                dev, swapchain_->getSwapchain(), UINT64_MAX,
+                frameSync_.getImageAvailable(currentFrame_), VK_NULL_HANDLE,
+                &currentImageIndex_);
+        };
+        VkResult result = acquire();
+        while (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapchain();
+            result = acquire();
+        }
     }
-    VkResult result =
-        vkAcquireNextImageKHR(dev, swapchain_->getSwapchain(), UINT64_MAX,
-                              frameSync_.getImageAvailable(currentFrame_),
-                              VK_NULL_HANDLE, &currentImageIndex_);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        renderGraph_.endFrame();
-        return;
+    // Reset only once an image is acquired, so a recreate above never
+    // leaves the fence unsignalled with no submission pending.
+    VkFence fence = frameSync_.getInFlightFence(currentFrame_);
+    vkResetFences(dev, 1, &fence);
+
+    renderResources_.updateUniforms(currentFrame_, cam_);
+
+    VkCommandBuffer cmd = commandManager_.get(currentFrame_);
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("Failed to begin command buffer");
+
+    secondaryCommands_.reset(dev, currentFrame_);
+
+    // Queries must be reset and begun outside of any rendering scope; they
+    // cover every pass of the frame.
+    vkCmdResetQueryPool(cmd, pipelineStatsQueryPool_, currentFrame_, 1);
+    vkCmdResetQueryPool(cmd, occlusionQueryPool_, currentFrame_, 1);
+    vkCmdBeginQuery(cmd, pipelineStatsQueryPool_, currentFrame_, 0);
+    vkCmdBeginQuery(cmd, occlusionQueryPool_, currentFrame_, 0);
+    if (timestampQueryPool_ != VK_NULL_HANDLE) {
+        uint32_t first = static_cast<uint32_t>(2 * currentFrame_);
+        vkCmdResetQueryPool(cmd, timestampQueryPool_, first, 2);
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+                             timestampQueryPool_, first);
     }
 
-    glm::mat4 viewProj = cam_.viewProjection();
-    VkImageLayout layout = renderGraph_.getFinalLayout();
-    renderGraph_.beginFrame(
-        renderResources_, commandManager_, currentFrame_, currentImageIndex_,
-        viewProj,
-        renderResources_.getSwapchain()->getImages()[currentImageIndex_],
-        layout);
+    renderGraph_.setImportedImage(
+        backbuffer_, swapchain_->getImages()[currentImageIndex_],
+        swapchain_->getImageViews()[currentImageIndex_]);
 }
 
 void RendererContext::endFrame() {
-    renderGraph_.endFrame();
-    renderGraph_.reset();
+    VkCommandBuffer cmd = commandManager_.get(currentFrame_);
+    renderGraph_.execute(cmd);
+    vkCmdEndQuery(cmd, pipelineStatsQueryPool_, currentFrame_);
+    vkCmdEndQuery(cmd, occlusionQueryPool_, currentFrame_);
+    if (timestampQueryPool_ != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+                             timestampQueryPool_,
+                             static_cast<uint32_t>(2 * currentFrame_ + 1));
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+        throw std::runtime_error("Failed to end command buffer");
 
     VkSubmitInfo submit{VK_STRUCTURE_TYPE_SUBMIT_INFO};
     VkSemaphore waitSems[] = {frameSync_.getImageAvailable(currentFrame_)};
@@ -109,16 +219,24 @@ void RendererContext::endFrame() {
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     VkSemaphore signalSems[] = {frameSync_.getRenderFinished(currentFrame_)};
 
-    submit.waitSemaphoreCount = 1;
+    // Offscreen frames have no acquire to wait on and nothing to present.
+    const bool presenting = !swapchain_->isOffscreen();
+    submit.waitSemaphoreCount = presenting ? 1 : 0;
     submit.pWaitSemaphores = waitSems;
     submit.pWaitDstStageMask = waitStages;
     submit.commandBufferCount = 1;
-    submit.pCommandBuffers = &renderGraph_.getCurrentCommandBuffer();
-    submit.signalSemaphoreCount = 1;
+    submit.pCommandBuffers = &cmd;
+    submit.signalSemaphoreCount = presenting ? 1 : 0;
     submit.pSignalSemaphores = signalSems;
 
     vkQueueSubmit(device_->getGraphicsQueue(), 1, &submit,
                   frameSync_.getInFlightFence(currentFrame_));
+    ++framesSubmitted_;
+
+    if (!presenting) {
+        currentFrame_ = (currentFrame_ + 1) % framesInFlight_;
+        return;
+    }
 
     VkPresentInfoKHR present{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
     present.waitSemaphoreCount = 1;
@@ -130,11 +248,43 @@ void RendererContext::endFrame() {
 
     VkResult result = vkQueuePresentKHR(device_->getGraphicsQueue(), &present);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        renderGraph_.reset();
         recreateSwapchain();
     }
 
-    currentFrame_ = (currentFrame_ + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame_ = (currentFrame_ + 1) % framesInFlight_;
+}
+
+bool RendererContext::parallelRecording() const {
+    return secondaryCommands_.threadCount() > 0 &&
+           device_->getEnabledFeatures().inheritedQueries;
+}
+
+VkCommandBuffer RendererContext::beginSecondary(size_t thread) {
+    VkCommandBuffer cmd = secondaryCommands_.get(currentFrame_, thread);
+
+    VkFormat colorFormat = renderResources_.getColorFormat();
+    VkCommandBufferInheritanceRenderingInfo rendering{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO};
+    rendering.colorAttachmentCount = 1;
+    rendering.pColorAttachmentFormats = &colorFormat;
+    rendering.depthAttachmentFormat = renderResources_.getDepthFormat();
+    rendering.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo inheritance{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    inheritance.pNext = &rendering;
+    inheritance.occlusionQueryEnable = VK_TRUE;
+    if (device_->getEnabledFeatures().pipelineStatisticsQuery)
+        inheritance.pipelineStatistics = PIPELINE_STATISTICS;
+
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                      VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("Failed to begin secondary command buffer");
+    return cmd;
 }
 
 void RendererContext::recreateSwapchain() {
@@ -143,14 +293,19 @@ void RendererContext::recreateSwapchain() {
     cam_.setAspect(float(swapchain_->getExtent().width) /
                    float(swapchain_->getExtent().height));
     renderResources_.recreate();
+    renderGraph_.resize(swapchain_->getExtent());
+    if (imguiDescriptorPool_ != VK_NULL_HANDLE)
+        ImGui_ImplVulkan_SetMinImageCount(swapchain_->getMinImageCount());
 }
 
 void RendererContext::cleanup() {
     vkDeviceWaitIdle(device_->getDevice());
-    if (DEBUG) {
+    if (imguiDescriptorPool_ != VK_NULL_HANDLE) {
         cleanupImGui();
     }
+    renderGraph_.cleanup();
     renderResources_.cleanup();
+    secondaryCommands_.cleanup(device_->getDevice());
     commandManager_.cleanup(device_->getDevice());
     frameSync_.cleanup(device_->getDevice());
     swapchain_->cleanup();
@@ -186,10 +341,17 @@ void RendererContext::initImGui(GLFWwindow *window) {
     init_info.QueueFamily = device_->getGraphicsQueueFamilyIndex();
     init_info.Queue = device_->getGraphicsQueue();
     init_info.DescriptorPool = imguiDescriptorPool_;
-    init_info.MinImageCount = 2;
-    init_info.ImageCount = 2;
+    init_info.MinImageCount = swapchain_->getMinImageCount();
+    init_info.ImageCount =
+        static_cast<uint32_t>(swapchain_->getImages().size());
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
-    init_info.RenderPass = renderResources_.getRenderPass();
+    init_info.UseDynamicRendering = true;
+    VkFormat colorFormat = renderResources_.getColorFormat();
+    init_info.PipelineRenderingCreateInfo = {
+        VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO};
+    init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+    init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats =
+        &colorFormat;
     init_info.CheckVkResultFn = nullptr;
     ImGui_ImplVulkan_Init(&init_info);
 
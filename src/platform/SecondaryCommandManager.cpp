@@ -0,0 +1,46 @@
+#include "engine/platform/SecondaryCommandManager.hpp"
+#include <stdexcept>
+
+void SecondaryCommandManager::init(VkDevice device, uint32_t queueFamilyIndex,
+                                   size_t framesInFlight, size_t threadCount) {
+    threadCount_ = threadCount;
+    pools_.resize(framesInFlight * threadCount);
+    commandBuffers_.resize(pools_.size());
+
+    for (size_t i = 0; i < pools_.size(); ++i) {
+        VkCommandPoolCreateInfo poolInfo{
+            VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        poolInfo.queueFamilyIndex = queueFamilyIndex;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &pools_[i]) !=
+            VK_SUCCESS)
+            throw std::runtime_error("Failed to create secondary command pool");
+
+        VkCommandBufferAllocateInfo allocInfo{
+            VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        allocInfo.commandPool = pools_[i];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &allocInfo,
+                                     &commandBuffers_[i]) != VK_SUCCESS)
+            throw std::runtime_error(
+                "Failed to allocate secondary command buffer");
+    }
+}
+
+void SecondaryCommandManager::cleanup(VkDevice device) {
+    for (VkCommandPool pool : pools_)
+        vkDestroyCommandPool(device, pool, nullptr);
+    pools_.clear();
+    commandBuffers_.clear();
+}
+
+void SecondaryCommandManager::reset(VkDevice device, size_t frameIndex) {
+    for (size_t t = 0; t < threadCount_; ++t)
+        vkResetCommandPool(device, pools_[frameIndex * threadCount_ + t], 0);
+}
+
+VkCommandBuffer SecondaryCommandManager::get(size_t frameIndex,
+                                             size_t thread) const {
+    return commandBuffers_.at(frameIndex * threadCount_ + thread);
+}
@@ -1,21 +1,36 @@
 
 #include "engine/platform/Swapchain.hpp"
+#include "engine/core/LaunchOptions.hpp"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <iostream>
 #include <stdexcept>
 
 Swapchain::Swapchain(VulkanDevice *device, VkSurfaceKHR surface,
-                     GLFWwindow *window)
-    : device_(device), surface_(surface), window_(window) {
+                     GLFWwindow *window, size_t framesInFlight,
+                     VkPresentModeKHR presentMode)
+    : device_(device), surface_(surface), window_(window),
+      framesInFlight_(framesInFlight), requestedPresentMode_(presentMode) {
     create();
     createImageViews();
 }
 
+Swapchain::Swapchain(VulkanDevice *device, VkExtent2D extent,
+                     size_t framesInFlight)
+    : device_(device), extent_(extent), framesInFlight_(framesInFlight),
+      requestedPresentMode_(VK_PRESENT_MODE_FIFO_KHR) {
+    createOffscreen();
+    createImageViews();
+}
+
 Swapchain::~Swapchain() { cleanup(); }
 
 void Swapchain::recreate() {
     cleanup();
-    create();
+    if (isOffscreen())
+        createOffscreen();
+    else
+        create();
     createImageViews();
 }
 
@@ -25,6 +40,12 @@ void Swapchain::cleanup() {
     }
     imageViews_.clear();
 
+    for (size_t i = 0; i < allocations_.size(); ++i)
+        vmaDestroyImage(device_->getAllocator(), images_[i], allocations_[i]);
+    allocations_.clear();
+    if (isOffscreen())
+        images_.clear();
+
     if (swapchain_ != VK_NULL_HANDLE) {
         vkDestroySwapchainKHR(device_->getDevice(), swapchain_, nullptr);
         swapchain_ = VK_NULL_HANDLE;
@@ -62,6 +83,16 @@ void Swapchain::create() {
                                               presentModes.data());
 
     VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    if (std::find(presentModes.begin(), presentModes.end(),
+                  requestedPresentMode_) != presentModes.end()) {
+        presentMode = requestedPresentMode_;
+    } else {
+        // Warn once; recreations then ask for FIFO directly.
+        std::cerr << "Present mode " << presentModeName(requestedPresentMode_)
+                  << " unsupported, using fifo" << std::endl;
+        requestedPresentMode_ = VK_PRESENT_MODE_FIFO_KHR;
+    }
+    presentMode_ = presentMode;
 
     int width, height;
     glfwGetFramebufferSize(window_, &width, &height);
@@ -72,12 +103,16 @@ void Swapchain::create() {
                                     capabilities.minImageExtent.height,
                                     capabilities.maxImageExtent.height)};
 
-    uint32_t imageCount = capabilities.minImageCount + 1;
+    uint32_t imageCount =
+        std::max(capabilities.minImageCount + 1,
+                 static_cast<uint32_t>(framesInFlight_) + 1);
     if (capabilities.maxImageCount > 0 &&
         imageCount > capabilities.maxImageCount) {
         imageCount = capabilities.maxImageCount;
     }
 
+    minImageCount_ = imageCount;
+
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     createInfo.surface = surface_;
@@ -108,6 +143,37 @@ void Swapchain::create() {
                             images_.data());
 }
 
+void Swapchain::createOffscreen() {
+    imageFormat_ = VK_FORMAT_B8G8R8A8_UNORM;
+    minImageCount_ = static_cast<uint32_t>(framesInFlight_);
+
+    VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = imageFormat_;
+    imageInfo.extent = {extent_.width, extent_.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    images_.resize(framesInFlight_);
+    allocations_.resize(framesInFlight_);
+    for (size_t i = 0; i < framesInFlight_; ++i) {
+        if (vmaCreateImage(device_->getAllocator(), &imageInfo, &allocInfo,
+                           &images_[i], &allocations_[i],
+                           nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image");
+        }
+    }
+}
+
 void Swapchain::createImageViews() {
     imageViews_.resize(images_.size());
     for (size_t i = 0; i < images_.size(); i++) {
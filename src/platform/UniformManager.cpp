@@ -1,27 +1,45 @@
 #include "engine/platform/UniformManager.hpp"
-#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+void UniformManager::init(VkDevice device, VkPhysicalDevice physDevice,
+                          VmaAllocator allocator, size_t frameCount,
+                          VkDeviceSize bytesPerFrame,
+                          VkDeviceSize bindingRange) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physDevice, &props);
+    alignment_ = std::max<VkDeviceSize>(
+        props.limits.minUniformBufferOffsetAlignment, 1);
+    frameBytes_ = alignUp(bytesPerFrame, alignment_);
 
-void UniformManager::init(VkDevice device, VmaAllocator allocator,
-                          size_t frameCount) {
-    VkDeviceSize bufferSize = sizeof(glm::mat4) * frameCount;
     VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-    bufferInfo.size = bufferSize;
+    bufferInfo.size = frameBytes_ * frameCount;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
     VmaAllocationCreateInfo allocInfo{};
     allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
     allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-    vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer_, &allocation_,
-                    nullptr);
+    VmaAllocationInfo info{};
+    if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer_,
+                        &allocation_, &info) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create uniform ring buffer");
+    mapped_ = static_cast<char *>(info.pMappedData);
 
     descriptorMgr_.init(device, 1);
 
     VkDescriptorBufferInfo dbi{};
     dbi.buffer = buffer_;
     dbi.offset = 0;
-    dbi.range = sizeof(glm::mat4);
+    dbi.range = bindingRange;
 
     VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
     write.dstSet = descriptorMgr_.getDescriptorSets()[0];
@@ -33,13 +51,18 @@ void UniformManager::init(VkDevice device, VmaAllocator allocator,
     vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
 }
 
-void UniformManager::update(VmaAllocator allocator, size_t frameIndex,
-                            const glm::mat4 &mat) {
-    void *mapped;
-    vmaMapMemory(allocator, allocation_, &mapped);
-    std::memcpy(static_cast<char *>(mapped) + sizeof(glm::mat4) * frameIndex,
-                &mat, sizeof(mat));
-    vmaUnmapMemory(allocator, allocation_);
+void UniformManager::beginFrame(size_t frameIndex) {
+    frameBase_ = frameBytes_ * frameIndex;
+    head_.store(0, std::memory_order_relaxed);
+}
+
+UniformManager::Allocation UniformManager::allocate(VkDeviceSize size) {
+    VkDeviceSize offset = head_.fetch_add(alignUp(size, alignment_),
+                                          std::memory_order_relaxed);
+    if (offset + size > frameBytes_)
+        throw std::runtime_error("Uniform ring frame region exhausted");
+    VkDeviceSize absolute = frameBase_ + offset;
+    return {mapped_ + absolute, static_cast<uint32_t>(absolute)};
 }
 
 void UniformManager::cleanup(VkDevice device, VmaAllocator allocator) {
@@ -47,4 +70,5 @@ void UniformManager::cleanup(VkDevice device, VmaAllocator allocator) {
     vmaDestroyBuffer(allocator, buffer_, allocation_);
     buffer_ = VK_NULL_HANDLE;
     allocation_ = VK_NULL_HANDLE;
+    mapped_ = nullptr;
 }
@@ -13,12 +13,13 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 }
 #endif
 
-VulkanDevice::VulkanDevice(GLFWwindow *window) {
+VulkanDevice::VulkanDevice(GLFWwindow *window) : headless_(window == nullptr) {
     createInstance();
 #ifdef ENABLE_VALIDATION_LAYERS
     setupDebugMessenger();
 #endif
-    createSurface(window);
+    if (!headless_)
+        createSurface(window);
     pickPhysicalDevice();
     createLogicalDevice();
     createCommandPool();
@@ -60,9 +61,13 @@ void VulkanDevice::createInstance() {
     appInfo.apiVersion = VK_API_VERSION_1_3;
 
     std::vector<const char *> extensions;
-    uint32_t glfwExtCount = 0;
-    const char **glfwExts = glfwGetRequiredInstanceExtensions(&glfwExtCount);
-    extensions.insert(extensions.end(), glfwExts, glfwExts + glfwExtCount);
+    if (!headless_) {
+        uint32_t glfwExtCount = 0;
+        const char **glfwExts =
+            glfwGetRequiredInstanceExtensions(&glfwExtCount);
+        extensions.insert(extensions.end(), glfwExts,
+                          glfwExts + glfwExtCount);
+    }
 
 #ifdef ENABLE_VALIDATION_LAYERS
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -118,6 +123,19 @@ void VulkanDevice::pickPhysicalDevice() {
     vkEnumeratePhysicalDevices(instance_, &count, devices.data());
 
     for (auto device : devices) {
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(device, &props);
+        VkPhysicalDeviceVulkan13Features features13{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+        VkPhysicalDeviceFeatures2 features{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+        features.pNext = &features13;
+        if (props.apiVersion < VK_API_VERSION_1_3)
+            continue;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!features13.dynamicRendering || !features13.synchronization2)
+            continue;
+
         uint32_t qCount;
         vkGetPhysicalDeviceQueueFamilyProperties(device, &qCount, nullptr);
         std::vector<VkQueueFamilyProperties> qProps(qCount);
@@ -125,8 +143,10 @@ void VulkanDevice::pickPhysicalDevice() {
                                                  qProps.data());
 
         for (uint32_t i = 0; i < qCount; ++i) {
-            VkBool32 present;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &present);
+            VkBool32 present = VK_TRUE;
+            if (!headless_)
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_,
+                                                     &present);
             if ((qProps[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && present) {
                 physicalDevice_ = device;
                 graphicsQueueFamilyIndex_ = i;
@@ -147,10 +167,25 @@ void VulkanDevice::createLogicalDevice() {
 
     const char *exts[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
+    VkPhysicalDeviceFeatures supported;
+    vkGetPhysicalDeviceFeatures(physicalDevice_, &supported);
+    // Statistics queries back the debug overlay; inherited queries let them
+    // stay active across secondary command buffers.
+    enabledFeatures_.pipelineStatisticsQuery =
+        supported.pipelineStatisticsQuery;
+    enabledFeatures_.inheritedQueries = supported.inheritedQueries;
+
+    VkPhysicalDeviceVulkan13Features features13{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+    features13.dynamicRendering = VK_TRUE;
+    features13.synchronization2 = VK_TRUE;
+
     VkDeviceCreateInfo ci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+    ci.pNext = &features13;
+    ci.pEnabledFeatures = &enabledFeatures_;
     ci.queueCreateInfoCount = 1;
     ci.pQueueCreateInfos = &qci;
-    ci.enabledExtensionCount = 1;
+    ci.enabledExtensionCount = headless_ ? 0 : 1;
     ci.ppEnabledExtensionNames = exts;
 
     if (vkCreateDevice(physicalDevice_, &ci, nullptr, &device_) != VK_SUCCESS)
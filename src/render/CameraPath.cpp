@@ -0,0 +1,105 @@
+#include "engine/render/CameraPath.hpp"
+#include "engine/render/Camera.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace engine::render {
+
+namespace {
+template <typename T, typename S>
+T catmullRom(const T &p0, const T &p1, const T &p2, const T &p3, S f) {
+    S f2 = f * f, f3 = f2 * f;
+    return S(0.5) * ((S(2) * p1) + (p2 - p0) * f +
+                     (S(2) * p0 - S(5) * p1 + S(4) * p2 - p3) * f2 +
+                     (S(3) * p1 - p0 - S(3) * p2 + p3) * f3);
+}
+} // namespace
+
+CameraPath CameraPath::load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to open camera path " + path);
+
+    CameraPath result;
+    std::string line;
+    for (int lineNo = 1; std::getline(file, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        Keyframe key{};
+        float yawDeg, pitchDeg;
+        if (!(in >> key.time))
+            continue; // blank or comment-only
+        if (!(in >> key.position.x >> key.position.y >> key.position.z >>
+              yawDeg >> pitchDeg))
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) +
+                                     ": expected 't x y z yaw pitch'");
+        if (!result.keys_.empty() && key.time <= result.keys_.back().time)
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) +
+                                     ": keyframe times must increase");
+        key.yaw = glm::radians(yawDeg);
+        key.pitch = glm::radians(pitchDeg);
+        result.addKeyframe(key);
+    }
+    if (result.keys_.empty())
+        throw std::runtime_error("Camera path " + path + " has no keyframes");
+    return result;
+}
+
+void CameraPath::save(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to write camera path " + path);
+    file << "# time_s  x y z  yaw_deg pitch_deg\n";
+    // Fixed notation keeps far-from-origin positions from being rounded to
+    // six significant digits.
+    file << std::fixed << std::setprecision(4);
+    for (const Keyframe &k : keys_) {
+        file << k.time << ' ' << k.position.x << ' ' << k.position.y << ' '
+             << k.position.z << ' ' << glm::degrees(k.yaw) << ' '
+             << glm::degrees(k.pitch) << '\n';
+    }
+}
+
+void CameraPath::addKeyframe(const Keyframe &key) {
+    if (!keys_.empty() && key.time <= keys_.back().time)
+        throw std::runtime_error("Camera path keyframe times must increase");
+    keys_.push_back(key);
+}
+
+float CameraPath::duration() const {
+    return keys_.empty() ? 0.0f : keys_.back().time - keys_.front().time;
+}
+
+void CameraPath::apply(float t, Camera &camera) const {
+    if (keys_.empty())
+        return;
+    t = std::clamp(t + keys_.front().time, keys_.front().time,
+                   keys_.back().time);
+    auto next = std::upper_bound(
+        keys_.begin(), keys_.end(), t,
+        [](float time, const Keyframe &k) { return time < k.time; });
+    if (next == keys_.end()) {
+        camera.setPosition(keys_.back().position);
+        camera.setRotation(keys_.back().yaw, keys_.back().pitch);
+        return;
+    }
+
+    // Segment p1 -> p2 with neighbours p0 and p3, clamped at the ends.
+    size_t i2 = size_t(next - keys_.begin());
+    size_t i1 = i2 - 1;
+    size_t i0 = i1 > 0 ? i1 - 1 : i1;
+    size_t i3 = std::min(i2 + 1, keys_.size() - 1);
+    const Keyframe &k0 = keys_[i0], &k1 = keys_[i1];
+    const Keyframe &k2 = keys_[i2], &k3 = keys_[i3];
+    float f = (t - k1.time) / (k2.time - k1.time);
+
+    camera.setPosition(catmullRom(k0.position, k1.position, k2.position,
+                                  k3.position, double(f)));
+    camera.setRotation(catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, f),
+                       catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, f));
+}
+
+} // namespace engine::render
@@ -1,18 +1,31 @@
 #include "engine/render/Mesh.hpp"
 #include "engine/utils/VulkanHelpers.hpp"
+#include <algorithm>
+#include <cstring>
 
 using engine::utils::CreateBuffer;
 
-void Mesh::setVertices(std::vector<Vertex> &&v) { vertices_ = std::move(v); }
-
-void Mesh::setIndices(std::vector<uint32_t> &&i) {
-    indices_ = std::move(i);
+void Mesh::setGeometry(std::span<const Vertex> vertices,
+                       std::span<const uint32_t> indices) {
+    instanceOffset_ = sizeof(Vertex) * vertices.size();
+    vertexData_.resize(instanceOffset_ + sizeof(MeshInstance));
+    std::copy_n(reinterpret_cast<const std::byte *>(vertices.data()),
+                instanceOffset_, vertexData_.data());
+    indices_.assign(indices.begin(), indices.end());
     indices_count_ = indices_.size();
 }
+
 void Mesh::uploadToGPU(VulkanDevice *dev) {
+    // Vertices followed by the instance record, so a draw binds one buffer
+    // at two offsets instead of pushing a transform.
+    MeshInstance instance{glm::ivec4(origin_.x, 0, origin_.y, 0)};
+    std::memcpy(vertexData_.data() + instanceOffset_, &instance,
+                sizeof(instance));
+
+    device_ = dev->getDevice();
     CreateBuffer(dev->getDevice(), dev->getPhysicalDevice(),
                  dev->getCommandPool(), dev->getGraphicsQueue(),
-                 vertices_.data(), sizeof(Vertex) * vertices_.size(),
+                 vertexData_.data(), vertexData_.size(),
                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vbo_, vboMem_);
 
     CreateBuffer(dev->getDevice(), dev->getPhysicalDevice(),
@@ -20,6 +33,35 @@ void Mesh::uploadToGPU(VulkanDevice *dev) {
                  indices_.data(), sizeof(uint32_t) * indices_.size(),
                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT, ibo_, iboMem_);
 
-    vertices_.clear();
+    vertexData_.clear();
     indices_.clear();
 }
+
+void Mesh::destroy() {
+    if (device_ == VK_NULL_HANDLE)
+        return;
+    vkDestroyBuffer(device_, vbo_, nullptr);
+    vkFreeMemory(device_, vboMem_, nullptr);
+    vkDestroyBuffer(device_, ibo_, nullptr);
+    vkFreeMemory(device_, iboMem_, nullptr);
+    vbo_ = ibo_ = VK_NULL_HANDLE;
+    vboMem_ = iboMem_ = VK_NULL_HANDLE;
+    indices_count_ = 0;
+    device_ = VK_NULL_HANDLE;
+}
+
+void MeshRetireQueue::advance(uint64_t frame, size_t framesInFlight) {
+    frame_ = frame;
+    framesInFlight_ = framesInFlight;
+    while (!meshes_.empty() && meshes_.front().first <= frame)
+        meshes_.pop_front();
+}
+
+void MeshRetireQueue::retire(std::unique_ptr<Mesh> mesh) {
+    if (!mesh)
+        return;
+    // Frames up to frame_ - 1 may have recorded draws of it. Once the
+    // frame framesInFlight_ later is ready to begin, its slot's fence has
+    // covered all of them.
+    meshes_.emplace_back(frame_ + framesInFlight_, std::move(mesh));
+}
@@ -1,7 +1,6 @@
 #include "engine/render/Pipeline.hpp"
 #include "engine/render/Vertex.hpp"
 #include <fstream>
-#include <glm/mat4x4.hpp>
 #include <stdexcept>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -18,8 +17,10 @@ static std::vector<char> loadSPV(const std::string &path) {
     return buf;
 }
 
-void Pipeline::init(VkDevice dev, VkRenderPass rp, VkDescriptorSetLayout dsl,
-                    const std::string &vpath, const std::string &fpath) {
+void Pipeline::init(VkDevice dev, VkFormat colorFormat,
+                    VkFormat depthFormat, VkDescriptorSetLayout dsl,
+                    const std::string &vpath, const std::string &fpath,
+                    VkPipelineCache cache) {
     auto vcode = loadSPV(vpath);
     auto fcode = loadSPV(fpath);
 
@@ -48,19 +49,21 @@ void Pipeline::init(VkDevice dev, VkRenderPass rp, VkDescriptorSetLayout dsl,
     stages[1].module = fs;
     stages[1].pName = "main";
 
-    VkVertexInputBindingDescription bind{0, sizeof(Vertex),
-                                         VK_VERTEX_INPUT_RATE_VERTEX};
-    VkVertexInputAttributeDescription attr[4] = {
+    VkVertexInputBindingDescription binds[2] = {
+        {0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX},
+        {1, sizeof(MeshInstance), VK_VERTEX_INPUT_RATE_INSTANCE}};
+    VkVertexInputAttributeDescription attr[5] = {
         {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, pos)},
         {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)},
         {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)},
-        {3, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)}};
+        {3, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)},
+        {4, 1, VK_FORMAT_R32G32B32_SINT, offsetof(MeshInstance, chunk)}};
 
     VkPipelineVertexInputStateCreateInfo vis{
         VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-    vis.vertexBindingDescriptionCount = 1;
-    vis.pVertexBindingDescriptions = &bind;
-    vis.vertexAttributeDescriptionCount = 4;
+    vis.vertexBindingDescriptionCount = 2;
+    vis.pVertexBindingDescriptions = binds;
+    vis.vertexAttributeDescriptionCount = 5;
     vis.pVertexAttributeDescriptions = attr;
 
     VkPipelineInputAssemblyStateCreateInfo ias{
@@ -104,23 +107,23 @@ void Pipeline::init(VkDevice dev, VkRenderPass rp, VkDescriptorSetLayout dsl,
     dsc.dynamicStateCount = static_cast<uint32_t>(dyn.size());
     dsc.pDynamicStates = dyn.data();
 
-    VkPushConstantRange push{};
-    push.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    push.offset = 0;
-    push.size = sizeof(glm::mat4);
-
     VkPipelineLayoutCreateInfo pli{
         VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
     pli.setLayoutCount = 1;
     pli.pSetLayouts = &dsl;
-    pli.pushConstantRangeCount = 1;
-    pli.pPushConstantRanges = &push;
 
     if (vkCreatePipelineLayout(dev, &pli, nullptr, &layout) != VK_SUCCESS)
         throw std::runtime_error{"Failed to create pipeline layout"};
 
+    VkPipelineRenderingCreateInfo rci{
+        VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO};
+    rci.colorAttachmentCount = 1;
+    rci.pColorAttachmentFormats = &colorFormat;
+    rci.depthAttachmentFormat = depthFormat;
+
     VkGraphicsPipelineCreateInfo gpi{
         VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    gpi.pNext = &rci;
     gpi.stageCount = 2;
     gpi.pStages = stages;
     gpi.pVertexInputState = &vis;
@@ -132,10 +135,9 @@ void Pipeline::init(VkDevice dev, VkRenderPass rp, VkDescriptorSetLayout dsl,
     gpi.pColorBlendState = &cb;
     gpi.pDynamicState = &dsc;
     gpi.layout = layout;
-    gpi.renderPass = rp;
-    gpi.subpass = 0;
+    gpi.renderPass = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &gpi, nullptr,
+    if (vkCreateGraphicsPipelines(dev, cache, 1, &gpi, nullptr,
                                   &pipeline) != VK_SUCCESS)
         throw std::runtime_error{"Failed to create graphics pipeline"};
 
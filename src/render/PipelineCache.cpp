@@ -0,0 +1,104 @@
+#include "engine/render/PipelineCache.hpp"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace engine::render {
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x48435056; // "VPCH"
+
+struct CacheFileHeader {
+    uint32_t magic;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t uuid[VK_UUID_SIZE];
+    uint64_t dataSize;
+};
+
+bool matches(const CacheFileHeader &h, const VkPhysicalDeviceProperties &p) {
+    return h.magic == CACHE_MAGIC && h.vendorID == p.vendorID &&
+           h.deviceID == p.deviceID && h.driverVersion == p.driverVersion &&
+           std::memcmp(h.uuid, p.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+} // namespace
+
+void PipelineCache::init(VkDevice device, VkPhysicalDevice physDevice,
+                         const std::string &path) {
+    path_ = path;
+    vkGetPhysicalDeviceProperties(physDevice, &props_);
+
+    std::vector<char> data;
+    std::ifstream file(path_, std::ios::binary);
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(path_, ec);
+    CacheFileHeader header{};
+    // The size on disk must agree with the header before anything is
+    // allocated from it; a damaged file just starts an empty cache.
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+        matches(header, props_) && !ec &&
+        header.dataSize == fileSize - sizeof(header)) {
+        data.resize(header.dataSize);
+        if (!file.read(data.data(), std::streamsize(data.size())))
+            data.clear();
+    }
+
+    VkPipelineCacheCreateInfo ci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(device, &ci, nullptr, &cache_) != VK_SUCCESS) {
+        // A rejected blob is not fatal; fall back to an empty cache.
+        ci.initialDataSize = 0;
+        ci.pInitialData = nullptr;
+        if (vkCreatePipelineCache(device, &ci, nullptr, &cache_) !=
+            VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline cache");
+    }
+}
+
+void PipelineCache::save(VkDevice device) const {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, cache_, &size, nullptr) != VK_SUCCESS ||
+        size == 0)
+        return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, cache_, &size, data.data()) !=
+        VK_SUCCESS)
+        return;
+
+    CacheFileHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.vendorID = props_.vendorID;
+    header.deviceID = props_.deviceID;
+    header.driverVersion = props_.driverVersion;
+    std::memcpy(header.uuid, props_.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = size;
+
+    // Write to a temporary and rename so a crash never leaves a torn file.
+    const std::string tmpPath = path_ + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(data.data(), std::streamsize(size));
+        if (!out)
+            return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path_, ec);
+}
+
+void PipelineCache::cleanup(VkDevice device) {
+    if (cache_ == VK_NULL_HANDLE)
+        return;
+    save(device);
+    vkDestroyPipelineCache(device, cache_, nullptr);
+    cache_ = VK_NULL_HANDLE;
+}
+
+} // namespace engine::render
@@ -0,0 +1,37 @@
+#include "engine/utils/FrameLimiter.hpp"
+#include <thread>
+
+namespace engine::utils {
+
+namespace {
+// Left to a busy-wait; covers typical sleep overshoot.
+constexpr auto SPIN_MARGIN = std::chrono::microseconds(1500);
+} // namespace
+
+FrameLimiter::FrameLimiter(double fps) { setTarget(fps); }
+
+void FrameLimiter::setTarget(double fps) {
+    fps_ = fps > 0.0 ? fps : 0.0;
+    period_ = fps_ > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(1.0 / fps_))
+                         : Clock::duration::zero();
+    next_ = Clock::now();
+}
+
+void FrameLimiter::wait() {
+    if (fps_ <= 0.0)
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (next_ > now + SPIN_MARGIN)
+        std::this_thread::sleep_until(next_ - SPIN_MARGIN);
+    while (Clock::now() < next_)
+        std::this_thread::yield();
+
+    now = Clock::now();
+    next_ += period_;
+    if (next_ < now)
+        next_ = now + period_;
+}
+
+} // namespace engine::utils
@@ -1,146 +1,271 @@
 #include "engine/voxel/VoxelMesher.hpp"
+#include "engine/render/GeometryScratch.hpp"
 #include "engine/render/Vertex.hpp"
+#include "engine/world/Config.hpp"
+#include <chrono>
+#include <cstdint>
 #include <glm/vec3.hpp>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 using namespace engine;
 using namespace engine::voxel;
 
-std::unique_ptr<Mesh> VoxelMesher::GenerateMesh(const VoxelVolume &vol) {
-    const glm::ivec3 size = vol.extent;
-    std::vector<Vertex> verts;
-    std::vector<uint32_t> idxs;
-
-    for (int d = 0; d < 3; ++d) {
-        int u = (d + 1) % 3;
-        int v = (d + 2) % 3;
-
-        const int U = size[u], V = size[v];
-        std::vector<int> mask(U * V);
-        std::vector<glm::vec3> faceColorMask(U * V);
-
-        for (int dir = 1; dir >= -1; dir -= 2) {
-            for (int x = 0; x <= size[d]; ++x) {
-
-                for (int j = 0; j < V; ++j) {
-                    for (int i = 0; i < U; ++i) {
-                        glm::ivec3 a{0}, b{0};
-                        a[d] = x - (dir == 1);
-                        b[d] = x;
-                        a[u] = b[u] = i;
-                        a[v] = b[v] = j;
-
-                        auto inBounds = [&](const glm::ivec3 &p) {
-                            return p.x >= 0 && p.y >= 0 && p.z >= 0 &&
-                                   p.x < size.x && p.y < size.y && p.z < size.z;
-                        };
-
-                        bool va =
-                            inBounds(a) ? vol.at(a.x, a.y, a.z).solid : false;
-                        bool vb =
-                            inBounds(b) ? vol.at(b.x, b.y, b.z).solid : false;
-
-                        if (va != vb) {
-                            mask[j * U + i] = (va ? dir : -dir);
-                            glm::ivec3 voxelCoord = va ? a : b;
-                            faceColorMask[j * U + i] =
-                                vol.at(voxelCoord.x, voxelCoord.y, voxelCoord.z)
-                                    .color;
-                        } else {
-                            mask[j * U + i] = 0;
-                            faceColorMask[j * U + i] = glm::vec3(0.0f);
-                        }
-                    }
-                }
+namespace {
+/// Face mask of one slice: +1/-1 where the face points along +d/-d, 0 where
+/// there is none, plus the colour of the solid side.
+template <int N> struct FixedSlice {
+    void resize(int) {}
+    int8_t mask[N];
+    glm::vec3 color[N];
+};
 
-                for (int j = 0; j < V; ++j) {
-                    for (int i = 0; i < U; ++i) {
-                        int m = mask[j * U + i];
-                        if (m == 0)
-                            continue;
+struct DynamicSlice {
+    void resize(int n) {
+        mask.resize(n);
+        color.resize(n);
+    }
+    std::vector<int8_t> mask;
+    std::vector<glm::vec3> color;
+};
 
-                        glm::vec3 currentColor = faceColorMask[j * U + i];
+/// Volume size known at compile time: loop bounds are constants and the
+/// slice masks live on the stack.
+template <int SX, int SY, int SZ> struct FixedExtent {
+    static constexpr int DIMS[3] = {SX, SY, SZ};
+    template <int A> static constexpr int dim() { return DIMS[A]; }
+    template <int D>
+    using Slice = FixedSlice<DIMS[(D + 1) % 3] * DIMS[(D + 2) % 3]>;
+};
 
-                        int w = 1;
-                        while (i + w < U && mask[j * U + (i + w)] == m &&
-                               faceColorMask[j * U + (i + w)] == currentColor) {
-                            ++w;
-                        }
+/// Any other size, read from the volume.
+struct RuntimeExtent {
+    glm::ivec3 size;
+    template <int A> int dim() const { return size[A]; }
+};
 
-                        int h = 1;
-                        bool rowOK = true;
-                        while (j + h < V && rowOK) {
-                            for (int k = 0; k < w; ++k) {
-                                int idx = (j + h) * U + (i + k);
-                                if (mask[idx] != m ||
-                                    faceColorMask[idx] != currentColor) {
-                                    rowOK = false;
-                                    break;
-                                }
-                            }
-                            if (rowOK)
-                                ++h;
-                        }
+/// Masks for runtime-extent volumes, kept per thread beside the shared
+/// GeometryScratch; fixed-extent masks live on the stack.
+DynamicSlice &threadSlice() {
+    thread_local DynamicSlice slice;
+    return slice;
+}
 
-                        glm::vec3 origin{0}, du{0}, dv{0}, normal{0};
-                        origin[d] = float(x);
-                        origin[u] = float(i);
-                        origin[v] = float(j);
-                        du[u] = float(w);
-                        dv[v] = float(h);
-                        normal[d] = float(m);
-
-                        glm::vec3 p0 = origin;
-                        glm::vec3 p1 = origin + du;
-                        glm::vec3 p2 = origin + du + dv;
-                        glm::vec3 p3 = origin + dv;
-
-                        uint32_t base = uint32_t(verts.size());
-
-                        if (m > 0) {
-                            verts.push_back({p0, normal, {0, 0}, currentColor});
-                            verts.push_back(
-                                {p1, normal, {float(w), 0}, currentColor});
-                            verts.push_back({p2,
-                                             normal,
-                                             {float(w), float(h)},
-                                             currentColor});
-                            verts.push_back(
-                                {p3, normal, {0, float(h)}, currentColor});
-                            idxs.insert(idxs.end(), {base, base + 1, base + 2,
-                                                     base, base + 2, base + 3});
-                        } else {
-                            verts.push_back({p0, normal, {0, 0}, currentColor});
-                            verts.push_back(
-                                {p3, normal, {0, float(h)}, currentColor});
-                            verts.push_back({p2,
-                                             normal,
-                                             {float(w), float(h)},
-                                             currentColor});
-                            verts.push_back(
-                                {p1, normal, {float(w), 0}, currentColor});
-                            idxs.insert(idxs.end(), {base, base + 1, base + 2,
-                                                     base, base + 2, base + 3});
-                        }
+/// Extent of a chunk downsampled for `lod`, as VoxelVolume::downsample
+/// rounds it.
+constexpr int lodDim(int dim, size_t lod) {
+    return (dim + (1 << lod) - 1) >> lod;
+}
+
+/// Greedy-meshes the slices perpendicular to axis D.
+template <int D, typename Extent, typename Layout, typename Slice>
+void sweepAxis(const BasicVoxelVolume<Layout> &vol, const Extent &ext,
+               Slice &slice, float scale, std::vector<Vertex> &verts,
+               std::vector<uint32_t> &idxs) {
+    constexpr int u = (D + 1) % 3;
+    constexpr int v = (D + 2) % 3;
+    const int N = ext.template dim<D>();
+    const int U = ext.template dim<u>();
+    const int V = ext.template dim<v>();
+
+    slice.resize(U * V);
+    auto &mask = slice.mask;
+    auto &faceColorMask = slice.color;
+
+    // 0 if layer y is known all air, 1 if known all solid, -1 if mixed.
+    auto layerState = [&](int y) {
+        if (y < 0 || y >= N)
+            return 0;
+        const int s = vol.sectionOf(y);
+        if (vol.sectionAllAir(s))
+            return 0;
+        return vol.sectionAllSolid(s) ? 1 : -1;
+    };
+
+    // One pass per slice boundary x covers both face directions: the sign
+    // of the mask says which side of the boundary is solid.
+    for (int x = 0; x <= N; ++x) {
+        // Between two layers of uniform sections with the same state there
+        // can be no faces; skip the whole slice.
+        if constexpr (D == 1) {
+            if (layerState(x - 1) != -1 && layerState(x - 1) == layerState(x))
+                continue;
+        }
+
+        auto fillCell = [&](int i, int j) {
+            glm::ivec3 a{0}, b{0};
+            a[D] = x - 1;
+            b[D] = x;
+            a[u] = b[u] = i;
+            a[v] = b[v] = j;
+
+            bool va = x > 0 && vol.isSolid(a.x, a.y, a.z);
+            bool vb = x < N && vol.isSolid(b.x, b.y, b.z);
+
+            if (va != vb) {
+                mask[j * U + i] = int8_t(va ? 1 : -1);
+                glm::ivec3 voxelCoord = va ? a : b;
+                faceColorMask[j * U + i] =
+                    vol.atUnchecked(voxelCoord.x, voxelCoord.y, voxelCoord.z)
+                        .color;
+            } else {
+                mask[j * U + i] = 0;
+                faceColorMask[j * U + i] = glm::vec3(0.0f);
+            }
+        };
+        // Walk the slice in storage order: the lower-numbered of u and v is
+        // the faster axis in every layout.
+        if constexpr (u < v)
+            forEachTiled<Layout>(U, V, fillCell);
+        else
+            forEachTiled<Layout>(V, U, [&](int j, int i) { fillCell(i, j); });
+
+        for (int j = 0; j < V; ++j) {
+            for (int i = 0; i < U; ++i) {
+                int m = mask[j * U + i];
+                if (m == 0)
+                    continue;
+
+                glm::vec3 currentColor = faceColorMask[j * U + i];
 
-                        for (int yy = 0; yy < h; ++yy) {
-                            for (int xx = 0; xx < w; ++xx) {
-                                int idx = (j + yy) * U + (i + xx);
-                                mask[idx] = 0;
-                                faceColorMask[idx] = glm::vec3(0.0f);
-                            }
+                int w = 1;
+                while (i + w < U && mask[j * U + (i + w)] == m &&
+                       faceColorMask[j * U + (i + w)] == currentColor) {
+                    ++w;
+                }
+
+                int h = 1;
+                bool rowOK = true;
+                while (j + h < V && rowOK) {
+                    for (int k = 0; k < w; ++k) {
+                        int idx = (j + h) * U + (i + k);
+                        if (mask[idx] != m ||
+                            faceColorMask[idx] != currentColor) {
+                            rowOK = false;
+                            break;
                         }
+                    }
+                    if (rowOK)
+                        ++h;
+                }
+
+                glm::vec3 origin{0}, du{0}, dv{0}, normal{0};
+                origin[D] = float(x) * scale;
+                origin[u] = float(i) * scale;
+                origin[v] = float(j) * scale;
+                const float uw = float(w) * scale;
+                const float vh = float(h) * scale;
+                du[u] = uw;
+                dv[v] = vh;
+                normal[D] = float(m);
 
-                        i += w - 1;
+                glm::vec3 p0 = origin;
+                glm::vec3 p1 = origin + du;
+                glm::vec3 p2 = origin + du + dv;
+                glm::vec3 p3 = origin + dv;
+
+                uint32_t base = uint32_t(verts.size());
+
+                if (m > 0) {
+                    verts.push_back({p0, normal, {0, 0}, currentColor});
+                    verts.push_back({p1, normal, {uw, 0}, currentColor});
+                    verts.push_back({p2, normal, {uw, vh}, currentColor});
+                    verts.push_back({p3, normal, {0, vh}, currentColor});
+                } else {
+                    verts.push_back({p0, normal, {0, 0}, currentColor});
+                    verts.push_back({p3, normal, {0, vh}, currentColor});
+                    verts.push_back({p2, normal, {uw, vh}, currentColor});
+                    verts.push_back({p1, normal, {uw, 0}, currentColor});
+                }
+                idxs.insert(idxs.end(), {base, base + 1, base + 2, base,
+                                         base + 2, base + 3});
+
+                for (int yy = 0; yy < h; ++yy) {
+                    for (int xx = 0; xx < w; ++xx) {
+                        int idx = (j + yy) * U + (i + xx);
+                        mask[idx] = 0;
+                        faceColorMask[idx] = glm::vec3(0.0f);
                     }
                 }
+
+                i += w - 1;
             }
         }
     }
+}
 
+template <typename Extent, typename Layout>
+void sweepAll(const BasicVoxelVolume<Layout> &vol, const Extent &ext,
+              float scale, MeshTimings *timings, GeometryScratch &scratch) {
+    using Clock = std::chrono::steady_clock;
+    auto sweep = [&]<int D>() {
+        const Clock::time_point start = Clock::now();
+        if constexpr (std::is_same_v<Extent, RuntimeExtent>) {
+            sweepAxis<D>(vol, ext, threadSlice(), scale, scratch.verts,
+                         scratch.idxs);
+        } else {
+            typename Extent::template Slice<D> slice;
+            sweepAxis<D>(vol, ext, slice, scale, scratch.verts,
+                         scratch.idxs);
+        }
+        if (timings)
+            timings->axisMs[D] += std::chrono::duration<double, std::milli>(
+                                      Clock::now() - start)
+                                      .count();
+    };
+    sweep.template operator()<0>();
+    sweep.template operator()<1>();
+    sweep.template operator()<2>();
+}
+
+/// Meshes with a FixedExtent if `vol` has the extent of a chunk at one of
+/// the LODs; false if it has some other size.
+template <typename Layout, size_t... Lod>
+bool sweepChunkExtent(const BasicVoxelVolume<Layout> &vol, float scale,
+                      MeshTimings *timings, GeometryScratch &scratch,
+                      std::index_sequence<Lod...>) {
+    using world::CHUNK_DIM;
+    auto tryLod = [&](auto lod) {
+        using Extent = FixedExtent<lodDim(CHUNK_DIM.x, lod),
+                                   lodDim(CHUNK_DIM.y, lod),
+                                   lodDim(CHUNK_DIM.z, lod)>;
+        if (vol.extent != glm::ivec3(Extent::DIMS[0], Extent::DIMS[1],
+                                     Extent::DIMS[2]))
+            return false;
+        sweepAll(vol, Extent{}, scale, timings, scratch);
+        return true;
+    };
+    return (tryLod(std::integral_constant<size_t, Lod>{}) || ...);
+}
+} // namespace
+
+template <typename Layout>
+std::unique_ptr<Mesh>
+VoxelMesher::GenerateMesh(const BasicVoxelVolume<Layout> &vol, int voxelSize,
+                          MeshTimings *timings) {
+    const float scale = float(voxelSize);
+    GeometryScratch &scratch = threadGeometryScratch();
+
+    constexpr size_t LODS = std::size(world::LOD_DISTANCES) + 1;
+    if (!sweepChunkExtent(vol, scale, timings, scratch,
+                          std::make_index_sequence<LODS>{}))
+        sweepAll(vol, RuntimeExtent{vol.extent}, scale, timings, scratch);
+
+    // The one copy out of the scratch buffers, into exactly-sized storage.
     auto mesh = std::make_unique<Mesh>();
-    mesh->setVertices(std::move(verts));
-    mesh->setIndices(std::move(idxs));
+    mesh->setGeometry(scratch.verts, scratch.idxs);
     return mesh;
 }
+
+template std::unique_ptr<Mesh>
+VoxelMesher::GenerateMesh(const BasicVoxelVolume<LinearLayout> &, int,
+                          MeshTimings *);
+template std::unique_ptr<Mesh>
+VoxelMesher::GenerateMesh(const BasicVoxelVolume<Brick4Layout> &, int,
+                          MeshTimings *);
+template std::unique_ptr<Mesh>
+VoxelMesher::GenerateMesh(const BasicVoxelVolume<MortonLayout> &, int,
+                          MeshTimings *);
@@ -1,21 +1,140 @@
 #include "engine/voxel/VoxelVolume.hpp"
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 
 using namespace engine::voxel;
 
-VoxelVolume::VoxelVolume(const glm::ivec3 &ext)
-    : extent(ext), data_(ext.x * ext.y * ext.z) {}
+template <typename Layout>
+BasicVoxelVolume<Layout>::BasicVoxelVolume(const glm::ivec3 &ext)
+    : extent(ext), padded_(Layout::padded(ext)),
+      data_(size_t(padded_.x) * padded_.y * padded_.z),
+      occupancy_((data_.size() + 63) / 64), sectionSolid_(sectionCount()) {}
 
-Voxel &VoxelVolume::at(int x, int y, int z) {
-    if (x < 0 || y < 0 || z < 0 || x >= extent.x || y >= extent.y ||
-        z >= extent.z)
-        throw std::out_of_range("VoxelVolume::at coords");
-    return data_[index(x, y, z)];
+template <typename Layout>
+uint32_t BasicVoxelVolume<Layout>::sectionVolume(int section) const {
+    int height = std::min(SECTION_HEIGHT, extent.y - section * SECTION_HEIGHT);
+    return uint32_t(extent.x) * uint32_t(height) * uint32_t(extent.z);
 }
 
-const Voxel &VoxelVolume::at(int x, int y, int z) const {
-    if (x < 0 || y < 0 || z < 0 || x >= extent.x || y >= extent.y ||
-        z >= extent.z)
+template <typename Layout>
+void BasicVoxelVolume<Layout>::set(int x, int y, int z, const Voxel &voxel) {
+    if (!contains(x, y, z))
+        throw std::out_of_range("VoxelVolume::set coords");
+    setUnchecked(x, y, z, voxel);
+}
+
+template <typename Layout>
+void BasicVoxelVolume<Layout>::setUnchecked(int x, int y, int z,
+                                            const Voxel &voxel) {
+    assert(contains(x, y, z));
+    const size_t i = index(x, y, z);
+    Voxel &dst = data_[i];
+    if (dst.solid != voxel.solid) {
+        occupancy_[i >> 6] ^= uint64_t(1) << (i & 63);
+        sectionSolid_[sectionOf(y)] += voxel.solid ? 1 : uint32_t(-1);
+    }
+    dst = voxel;
+}
+
+template <typename Layout>
+const Voxel &BasicVoxelVolume<Layout>::at(int x, int y, int z) const {
+    if (!contains(x, y, z))
         throw std::out_of_range("VoxelVolume::at coords");
     return data_[index(x, y, z)];
 }
+
+template <typename Layout>
+void BasicVoxelVolume<Layout>::checkBox(const glm::ivec3 &mn,
+                                        const glm::ivec3 &mx) const {
+    if (mn.x < 0 || mn.y < 0 || mn.z < 0 || mx.x > extent.x ||
+        mx.y > extent.y || mx.z > extent.z || mn.x > mx.x || mn.y > mx.y ||
+        mn.z > mx.z)
+        throw std::out_of_range("VoxelVolume box");
+}
+
+template <typename Layout>
+void BasicVoxelVolume<Layout>::copySlab(const glm::ivec3 &mn,
+                                        const glm::ivec3 &mx,
+                                        Voxel *out) const {
+    checkBox(mn, mx);
+    const size_t width = size_t(mx.x - mn.x);
+    for (int z = mn.z; z < mx.z; ++z) {
+        for (int y = mn.y; y < mx.y; ++y) {
+            if constexpr (std::is_same_v<Layout, LinearLayout>) {
+                const Voxel *src = data_.data() + index(mn.x, y, z);
+                out = std::copy(src, src + width, out);
+            } else {
+                for (int x = mn.x; x < mx.x; ++x)
+                    *out++ = data_[index(x, y, z)];
+            }
+        }
+    }
+}
+
+template <typename Layout>
+void BasicVoxelVolume<Layout>::fillRange(const glm::ivec3 &mn,
+                                         const glm::ivec3 &mx,
+                                         const Voxel &voxel) {
+    checkBox(mn, mx);
+    if constexpr (!std::is_same_v<Layout, LinearLayout>) {
+        // Rows are not contiguous in a tiled layout; go cell by cell.
+        for (int z = mn.z; z < mx.z; ++z)
+            for (int y = mn.y; y < mx.y; ++y)
+                for (int x = mn.x; x < mx.x; ++x)
+                    setUnchecked(x, y, z, voxel);
+        return;
+    }
+    for (int z = mn.z; z < mx.z; ++z) {
+        for (int y = mn.y; y < mx.y; ++y) {
+            const size_t first = index(mn.x, y, z);
+            const size_t last = index(mx.x, y, z);
+            std::fill(data_.begin() + first, data_.begin() + last, voxel);
+
+            // Set or clear the row's bits word by word, counting how many
+            // were solid before so the section count stays exact.
+            int64_t delta = 0;
+            for (size_t i = first; i < last;) {
+                const size_t bit = i & 63;
+                const size_t n = std::min<size_t>(64 - bit, last - i);
+                const uint64_t mask =
+                    (n == 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1)) << bit;
+                uint64_t &word = occupancy_[i >> 6];
+                const int before = std::popcount(word & mask);
+                word = voxel.solid ? (word | mask) : (word & ~mask);
+                delta += (voxel.solid ? int64_t(n) : 0) - before;
+                i += n;
+            }
+            sectionSolid_[sectionOf(y)] += uint32_t(delta);
+        }
+    }
+}
+
+template <typename Layout>
+BasicVoxelVolume<Layout>
+BasicVoxelVolume<Layout>::downsample(int factor) const {
+    glm::ivec3 coarseExt = (extent + glm::ivec3(factor - 1)) / factor;
+    BasicVoxelVolume out(coarseExt);
+
+    forEachInLayoutOrder<Layout>(coarseExt, [&](int cx, int cy, int cz) {
+        const Voxel &dst = out.data_[out.index(cx, cy, cz)];
+        int y1 = std::min((cy + 1) * factor, extent.y);
+        int z1 = std::min((cz + 1) * factor, extent.z);
+        int x1 = std::min((cx + 1) * factor, extent.x);
+        for (int y = y1 - 1; y >= cy * factor && !dst.solid; --y) {
+            for (int z = cz * factor; z < z1 && !dst.solid; ++z) {
+                for (int x = cx * factor; x < x1; ++x) {
+                    if (isSolid(x, y, z)) {
+                        out.set(cx, cy, cz, data_[index(x, y, z)]);
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    return out;
+}
+
+template class engine::voxel::BasicVoxelVolume<LinearLayout>;
+template class engine::voxel::BasicVoxelVolume<Brick4Layout>;
+template class engine::voxel::BasicVoxelVolume<MortonLayout>;
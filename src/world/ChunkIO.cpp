@@ -0,0 +1,168 @@
+#include "engine/world/ChunkIO.hpp"
+#include "engine/world/Config.hpp"
+#include <iostream>
+
+using namespace engine::world;
+using engine::voxel::VoxelVolume;
+
+ChunkIO::ChunkIO(RegionStore &store)
+    : store_(store), thread_([this] { run(); }) {}
+
+ChunkIO::~ChunkIO() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void ChunkIO::requestLoad(const glm::ivec2 &coord, int priority,
+                          LoadCallback done) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        reads_.emplace(priority, ReadRequest{coord, std::move(done)});
+    }
+    cv_.notify_one();
+}
+
+void ChunkIO::prefetch(std::vector<glm::ivec2> coords) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        prefetches_.insert(prefetches_.end(), coords.begin(), coords.end());
+    }
+    cv_.notify_one();
+}
+
+void ChunkIO::queueWrite(const glm::ivec2 &coord,
+                         std::shared_ptr<const VoxelVolume> volume) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        writes_[coord] = std::move(volume);
+    }
+    cv_.notify_one();
+}
+
+void ChunkIO::flush() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    flushRequested_ = true;
+    cv_.notify_one();
+    idleCv_.wait(lock,
+                    [this] { return writes_.empty() && writing_.empty(); });
+}
+
+void ChunkIO::cancelReads() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    reads_.clear();
+    idleCv_.wait(lock, [this] { return !reading_; });
+}
+
+size_t ChunkIO::pendingReads() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return reads_.size();
+}
+
+size_t ChunkIO::pendingWrites() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return writes_.size() + writing_.size();
+}
+
+void ChunkIO::run() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        cv_.wait(lock, [this] {
+            return stop_ || !reads_.empty() || !writes_.empty() ||
+                   !prefetches_.empty();
+        });
+
+        if (stop_)
+            reads_.clear();
+
+        for (int n = 0; n < IO_READ_BATCH && !reads_.empty(); ++n) {
+            ReadRequest req = std::move(reads_.begin()->second);
+            reads_.erase(reads_.begin());
+            reading_ = true;
+            lock.unlock();
+            serveRead(req);
+            lock.lock();
+            reading_ = false;
+            idleCv_.notify_all();
+        }
+
+        if (!prefetches_.empty()) {
+            std::vector<glm::ivec2> coords = std::move(prefetches_);
+            prefetches_.clear();
+            lock.unlock();
+            for (const glm::ivec2 &coord : coords) {
+                // A bad region only costs the hint; the load reports it.
+                try {
+                    store_.prefetch(coord);
+                } catch (const std::exception &e) {
+                    std::cerr << "Chunk prefetch failed: " << e.what()
+                              << std::endl;
+                }
+            }
+            lock.lock();
+        }
+
+        // Writes yield to reads unless enough have piled up to make a
+        // worthwhile batch, or someone is waiting on them.
+        if (!writes_.empty() &&
+            (reads_.empty() || stop_ || flushRequested_ ||
+             writes_.size() >= size_t(IO_WRITE_BATCH)))
+            writeBatch(lock);
+
+        if (stop_ && writes_.empty())
+            return;
+    }
+}
+
+void ChunkIO::serveRead(ReadRequest &req) {
+    std::shared_ptr<const VoxelVolume> pending;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = writes_.find(req.coord);
+        if (it != writes_.end()) {
+            pending = it->second;
+        } else if (auto w = writing_.find(req.coord); w != writing_.end()) {
+            pending = w->second;
+        }
+    }
+
+    std::unique_ptr<VoxelVolume> volume;
+    if (pending) {
+        volume = std::make_unique<VoxelVolume>(*pending);
+    } else {
+        volume = std::make_unique<VoxelVolume>(CHUNK_DIM);
+        try {
+            if (!store_.load(req.coord, *volume))
+                volume.reset();
+        } catch (const std::exception &e) {
+            std::cerr << "Chunk load failed, regenerating: " << e.what()
+                      << std::endl;
+            volume.reset();
+        }
+    }
+    req.done(std::move(volume));
+}
+
+void ChunkIO::writeBatch(std::unique_lock<std::mutex> &lock) {
+    writing_ = std::move(writes_);
+    writes_.clear();
+    flushRequested_ = false;
+    lock.unlock();
+
+    std::vector<std::pair<glm::ivec2, const VoxelVolume *>> batch;
+    batch.reserve(writing_.size());
+    for (const auto &[coord, volume] : writing_)
+        batch.push_back({coord, volume.get()});
+    try {
+        store_.saveBatch(batch);
+    } catch (const std::exception &e) {
+        std::cerr << "Chunk write failed: " << e.what() << std::endl;
+    }
+
+    lock.lock();
+    writing_.clear();
+    idleCv_.notify_all();
+}
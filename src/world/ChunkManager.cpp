@@ -2,54 +2,370 @@
 #include "engine/voxel/VoxelMesher.hpp"
 #include "engine/world/Config.hpp"
 #include "engine/world/TerrainGenerator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
 
 using namespace engine::world;
 
-ChunkManager::ChunkManager() = default;
+static int lodForDistance(int dist) {
+    int lod = 0;
+    for (int threshold : LOD_DISTANCES)
+        lod += dist >= threshold;
+    return lod;
+}
+
+static std::unique_ptr<Mesh> buildMesh(const engine::voxel::VoxelVolume &vol,
+                                       const glm::ivec2 &coord, int lod) {
+    std::unique_ptr<Mesh> mesh;
+    if (lod == 0) {
+        mesh = engine::voxel::VoxelMesher::GenerateMesh(vol);
+    } else {
+        const int factor = 1 << lod;
+        mesh = engine::voxel::VoxelMesher::GenerateMesh(vol.downsample(factor),
+                                                        factor);
+    }
+    mesh->setOrigin(coord);
+    return mesh;
+}
+
+static constexpr int COARSEST_CELL = 1 << std::size(LOD_DISTANCES);
+
+/// Widens [minY, maxY] to whole coarsest-LOD cells so downsampled meshes
+/// stay inside it.
+static void roundToCoarsestCell(int &minY, int &maxY) {
+    minY = minY / COARSEST_CELL * COARSEST_CELL;
+    maxY = std::min(maxY / COARSEST_CELL * COARSEST_CELL + COARSEST_CELL,
+                    CHUNK_DIM.y) -
+           1;
+}
+
+/// Solid height range of a volume, rounded with roundToCoarsestCell().
+/// minY > maxY if the volume is all air.
+static void solidHeightRange(const engine::voxel::VoxelVolume &vol, int &minY,
+                             int &maxY) {
+    auto layerHasSolid = [&](int y) {
+        const int s = vol.sectionOf(y);
+        if (vol.sectionAllAir(s) || vol.sectionAllSolid(s))
+            return !vol.sectionAllAir(s);
+        for (int z = 0; z < vol.extent.z; ++z)
+            for (int x = 0; x < vol.extent.x; ++x)
+                if (vol.isSolid(x, y, z))
+                    return true;
+        return false;
+    };
+    maxY = vol.extent.y - 1;
+    while (maxY >= 0 && !layerHasSolid(maxY))
+        --maxY;
+    minY = 0;
+    while (minY <= maxY && !layerHasSolid(minY))
+        ++minY;
+    if (minY <= maxY)
+        roundToCoarsestCell(minY, maxY);
+}
+
+int ChunkManager::selectLod(int dist, int currentLod) {
+    int lod = lodForDistance(dist);
+    if (lod > currentLod && lodForDistance(dist - LOD_HYSTERESIS) <= currentLod)
+        return currentLod;
+    return lod;
+}
+
+ChunkManager::ChunkManager()
+    : regionStore_(WORLD_SAVE_DIR), io_(regionStore_) {}
 
 void ChunkManager::initChunks(engine::utils::ThreadPool &threadPool) {
-    updateChunks(glm::vec3{0, 0, 0}, threadPool);
+    updateChunks(WorldPos{0, 0, 0}, threadPool);
 }
 
-void ChunkManager::updateChunks(const glm::vec3 &playerPos,
+void ChunkManager::updateChunks(const WorldPos &playerPos,
                                 engine::utils::ThreadPool &threadPool) {
-    glm::ivec2 playerChunk =
-        glm::ivec2(glm::floor(playerPos.x / float(CHUNK_DIM.x)),
-                   glm::floor(playerPos.z / float(CHUNK_DIM.z)));
+    glm::ivec2 playerChunk = chunkOf(playerPos);
+
+    if (playerChunk != lastPlayerChunk_)
+        prefetchAhead(playerChunk);
 
     for (int dz = -VIEW_RADIUS; dz <= VIEW_RADIUS; ++dz) {
         for (int dx = -VIEW_RADIUS; dx <= VIEW_RADIUS; ++dx) {
             glm::ivec2 coord = playerChunk + glm::ivec2(dx, dz);
             Chunk &chunk = chunks_[coord];
+            const int dist = std::max(std::abs(dx), std::abs(dz));
 
-            if (!chunk.volume && !chunk.meshJobQueued) {
+            if (chunk.volume && !chunk.meshJobQueued) {
+                if (selectLod(dist, chunk.lod) != chunk.lod)
+                    markDirty(coord);
+            } else if (!chunk.volume && !chunk.meshJobQueued) {
                 chunk.meshJobQueued = true;
-                glm::ivec3 chunkOrigin(coord.x * CHUNK_DIM.x, 0,
-                                       coord.y * CHUNK_DIM.z);
-                auto coordCopy = coord;
-
-                threadPool.enqueueJob([this, coordCopy, chunkOrigin,
-                                       &threadPool]() {
-                    auto volume =
-                        std::make_unique<engine::voxel::VoxelVolume>(CHUNK_DIM);
-                    engine::world::TerrainGenerator::Generate(*volume,
-                                                              chunkOrigin);
-
-                    auto meshJob =
-                        [volumeCopy =
-                             std::make_shared<engine::voxel::VoxelVolume>(
-                                 *volume)]() {
-                            return engine::voxel::VoxelMesher::GenerateMesh(
-                                *volumeCopy);
-                        };
-
-                    threadPool.enqueueMesh(
-                        glm::ivec3(coordCopy.x, 0, coordCopy.y), meshJob);
-
-                    std::lock_guard<std::mutex> lock(assignMtx_);
-                    chunkVolumesPending_.emplace(coordCopy, std::move(volume));
-                });
+                chunk.dirty = false;
+                chunk.lod = lodForDistance(dist);
+                const int lod = chunk.lod;
+
+                io_.requestLoad(
+                    coord, dist,
+                    [this, coord, lod, &threadPool](
+                        std::unique_ptr<engine::voxel::VoxelVolume> loaded) {
+                        std::shared_ptr<engine::voxel::VoxelVolume> volume(
+                            std::move(loaded));
+                        threadPool.enqueueJob(
+                            [this, coord, lod, volume, &threadPool]() {
+                                finishLoad(coord, lod, volume, threadPool);
+                            });
+                    });
             }
         }
     }
 }
+
+void ChunkManager::finishLoad(
+    const glm::ivec2 &coord, int lod,
+    const std::shared_ptr<engine::voxel::VoxelVolume> &loaded,
+    engine::utils::ThreadPool &threadPool) {
+    std::unique_ptr<engine::voxel::VoxelVolume> volume;
+    if (loaded) {
+        volume = std::make_unique<engine::voxel::VoxelVolume>(
+            std::move(*loaded));
+    } else {
+        volume = std::make_unique<engine::voxel::VoxelVolume>(CHUNK_DIM);
+        glm::ivec3 chunkOrigin(coord.x * CHUNK_DIM.x, 0, coord.y * CHUNK_DIM.z);
+        engine::world::TerrainGenerator::Generate(*volume, chunkOrigin);
+    }
+
+    auto snapshot = std::make_shared<const engine::voxel::VoxelVolume>(*volume);
+    if (!loaded)
+        io_.queueWrite(coord, snapshot);
+
+    threadPool.enqueueMesh(
+        glm::ivec3(coord.x, 0, coord.y),
+        [snapshot, coord, lod]() { return buildMesh(*snapshot, coord, lod); });
+
+    PendingVolume pending{std::move(volume), 0, 0};
+    solidHeightRange(*pending.volume, pending.minY, pending.maxY);
+
+    std::lock_guard<std::mutex> lock(assignMtx_);
+    chunkVolumesPending_.emplace(coord, std::move(pending));
+}
+
+void ChunkManager::installPendingVolumes() {
+    std::lock_guard<std::mutex> lock(assignMtx_);
+    for (auto &[coord, pending] : chunkVolumesPending_) {
+        Chunk &chunk = chunks_[coord];
+        chunk.volume = std::move(pending.volume);
+        chunk.solidMinY = pending.minY;
+        chunk.solidMaxY = pending.maxY;
+        index_.update(coord, chunk.solidMinY, chunk.solidMaxY);
+    }
+    chunkVolumesPending_.clear();
+}
+
+void ChunkManager::installUploaded(const glm::ivec2 &coord,
+                                   std::unique_ptr<Mesh> mesh) {
+    std::lock_guard<std::mutex> lock(assignMtx_);
+    uploadedMeshes_.emplace_back(coord, std::move(mesh));
+}
+
+void ChunkManager::installUploadedMeshes(MeshRetireQueue &retired) {
+    std::lock_guard<std::mutex> lock(assignMtx_);
+    for (auto &[coord, mesh] : uploadedMeshes_) {
+        Chunk &chunk = chunks_[coord];
+        retired.retire(std::move(chunk.mesh));
+        chunk.mesh = std::move(mesh);
+        chunk.meshJobQueued = false;
+    }
+    uploadedMeshes_.clear();
+}
+
+void ChunkManager::releaseMeshes() {
+    std::lock_guard<std::mutex> lock(assignMtx_);
+    uploadedMeshes_.clear();
+    for (auto &[coord, chunk] : chunks_)
+        chunk.mesh.reset();
+}
+
+void ChunkManager::prefetchAhead(const glm::ivec2 &playerChunk) {
+    glm::ivec2 delta = playerChunk - lastPlayerChunk_;
+    lastPlayerChunk_ = playerChunk;
+    glm::ivec2 dir{(delta.x > 0) - (delta.x < 0),
+                   (delta.y > 0) - (delta.y < 0)};
+
+    // The strips just outside the view ring that the player is heading into.
+    std::vector<glm::ivec2> ahead;
+    for (int k = 1; k <= PREFETCH_DEPTH; ++k) {
+        for (int t = -VIEW_RADIUS; t <= VIEW_RADIUS; ++t) {
+            if (dir.x != 0)
+                ahead.push_back(playerChunk +
+                                glm::ivec2(dir.x * (VIEW_RADIUS + k), t));
+            if (dir.y != 0)
+                ahead.push_back(playerChunk +
+                                glm::ivec2(t, dir.y * (VIEW_RADIUS + k)));
+        }
+    }
+    if (!ahead.empty())
+        io_.prefetch(std::move(ahead));
+}
+
+Chunk *ChunkManager::findResident(const glm::ivec2 &coord) {
+    auto it = chunks_.find(coord);
+    if (it == chunks_.end() || !it->second.volume)
+        return nullptr;
+    return &it->second;
+}
+
+void ChunkManager::markDirty(const glm::ivec2 &coord) {
+    Chunk *chunk = findResident(coord);
+    if (!chunk)
+        return;
+    chunk->dirty = true;
+    dirtyChunks_.insert(coord);
+}
+
+void ChunkManager::markEdited(const glm::ivec2 &coord,
+                              const glm::ivec3 &localMin,
+                              const glm::ivec3 &localMax) {
+    markDirty(coord);
+    if (localMin.x == 0)
+        markDirty(coord + glm::ivec2(-1, 0));
+    if (localMax.x == CHUNK_DIM.x - 1)
+        markDirty(coord + glm::ivec2(1, 0));
+    if (localMin.z == 0)
+        markDirty(coord + glm::ivec2(0, -1));
+    if (localMax.z == CHUNK_DIM.z - 1)
+        markDirty(coord + glm::ivec2(0, 1));
+}
+
+bool ChunkManager::setVoxel(const VoxelCoord &worldPos,
+                            const engine::voxel::Voxel &voxel) {
+    return fillRegion(worldPos, worldPos, voxel) != 0;
+}
+
+size_t ChunkManager::fillRegion(const VoxelCoord &mn, const VoxelCoord &mx,
+                                const engine::voxel::Voxel &voxel) {
+    VoxelCoord lo = glm::min(mn, mx);
+    VoxelCoord hi = glm::max(mn, mx);
+    lo.y = std::max<int64_t>(lo.y, 0);
+    hi.y = std::min<int64_t>(hi.y, CHUNK_DIM.y - 1);
+    if (lo.y > hi.y)
+        return 0;
+
+    const glm::ivec2 first = chunkOf(lo), last = chunkOf(hi);
+    size_t written = 0;
+    for (int cz = first.y; cz <= last.y; ++cz) {
+        for (int cx = first.x; cx <= last.x; ++cx) {
+            glm::ivec2 coord{cx, cz};
+            Chunk *chunk = findResident(coord);
+            if (!chunk)
+                continue;
+
+            // Clamp in 64-bit; the chunk-local result always fits an int.
+            const VoxelCoord origin = chunkOrigin(coord);
+            glm::ivec3 a(glm::max(lo - origin, VoxelCoord(0)));
+            glm::ivec3 b(glm::min(hi - origin, VoxelCoord(CHUNK_DIM - 1)));
+
+            chunk->volume->fillRange(a, b + 1, voxel);
+
+            chunk->edited = true;
+            if (voxel.solid) {
+                int minY = a.y, maxY = b.y;
+                roundToCoarsestCell(minY, maxY);
+                if (chunk->solidMinY <= chunk->solidMaxY) {
+                    minY = std::min(minY, chunk->solidMinY);
+                    maxY = std::max(maxY, chunk->solidMaxY);
+                }
+                chunk->solidMinY = minY;
+                chunk->solidMaxY = maxY;
+                index_.update(coord, minY, maxY);
+            }
+            written += size_t(b.x - a.x + 1) * size_t(b.y - a.y + 1) *
+                       size_t(b.z - a.z + 1);
+            markEdited(coord, a, b);
+        }
+    }
+    return written;
+}
+
+void ChunkManager::flushEdits(const WorldPos &playerPos,
+                              engine::utils::ThreadPool &threadPool) {
+    if (dirtyChunks_.empty())
+        return;
+
+    glm::ivec2 playerChunk = chunkOf(playerPos);
+
+    std::vector<glm::ivec2> order(dirtyChunks_.begin(), dirtyChunks_.end());
+    auto dist2 = [&](const glm::ivec2 &c) {
+        glm::ivec2 d = c - playerChunk;
+        return d.x * d.x + d.y * d.y;
+    };
+    std::sort(order.begin(), order.end(),
+              [&](const glm::ivec2 &a, const glm::ivec2 &b) {
+                  return dist2(a) < dist2(b);
+              });
+
+    // Chunk state is only written on this thread now that uploads land
+    // through installUploadedMeshes(), so no lock is needed here.
+    int issued = 0;
+    for (const glm::ivec2 &coord : order) {
+        if (issued >= MAX_REMESHES_PER_FRAME)
+            break;
+
+        Chunk *chunk = findResident(coord);
+        if (!chunk) {
+            dirtyChunks_.erase(coord);
+            continue;
+        }
+        // A mesh built from an older snapshot is still in flight; keep the
+        // chunk queued so the newer edits are picked up once it lands.
+        if (chunk->meshJobQueued)
+            continue;
+
+        glm::ivec2 d = glm::abs(coord - playerChunk);
+        int lod = selectLod(std::max(d.x, d.y), chunk->lod);
+        dirtyChunks_.erase(coord);
+        enqueueRemesh(*chunk, coord, lod, threadPool);
+        ++issued;
+    }
+}
+
+ChunkManager::StreamingStats ChunkManager::streamingStats() const {
+    StreamingStats stats;
+    stats.pendingRemeshes = dirtyChunks_.size();
+    for (const auto &[coord, chunk] : chunks_) {
+        if (chunk.mesh)
+            ++stats.meshed;
+        if (chunk.meshJobQueued)
+            ++stats.inFlight;
+    }
+    return stats;
+}
+
+void ChunkManager::cancelLoads() { io_.cancelReads(); }
+
+void ChunkManager::saveEditedChunks() {
+    for (auto &[coord, chunk] : chunks_) {
+        if (chunk.volume && chunk.edited) {
+            io_.queueWrite(coord, std::make_shared<engine::voxel::VoxelVolume>(
+                                      *chunk.volume));
+            chunk.edited = false;
+        }
+    }
+    io_.flush();
+}
+
+void ChunkManager::enqueueRemesh(Chunk &chunk, const glm::ivec2 &coord,
+                                 int lod,
+                                 engine::utils::ThreadPool &threadPool) {
+    const bool edited = chunk.edited;
+    chunk.edited = false;
+    chunk.meshJobQueued = true;
+    chunk.dirty = false;
+    chunk.lod = lod;
+
+    // The finished mesh takes the same path as a freshly loaded chunk's:
+    // uploaded, swapped in by installUploadedMeshes() and the old mesh
+    // retired once no frame in flight can draw it.
+    auto snapshot =
+        std::make_shared<const engine::voxel::VoxelVolume>(*chunk.volume);
+    if (edited)
+        io_.queueWrite(coord, snapshot);
+    threadPool.enqueueMesh(
+        glm::ivec3(coord.x, 0, coord.y),
+        [snapshot, coord, lod]() { return buildMesh(*snapshot, coord, lod); });
+}
@@ -0,0 +1,180 @@
+#include "engine/world/ChunkQuadtree.hpp"
+#include "engine/world/Config.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace engine::world;
+
+static bool isEmpty(int minY, int maxY) { return minY > maxY; }
+
+/// Entry and exit of a ray against a box, or false if it misses or the
+/// box starts beyond `maxDist`.
+static bool raySlab(const glm::dvec3 &origin, const glm::dvec3 &invDir,
+                    const glm::dvec3 &mn, const glm::dvec3 &mx,
+                    double maxDist, double &tEnter, double &tExit) {
+    tEnter = 0.0;
+    tExit = maxDist;
+    for (int a = 0; a < 3; ++a) {
+        // Parallel to this slab: inside it or never. Avoids 0 * inf.
+        if (std::isinf(invDir[a])) {
+            if (origin[a] < mn[a] || origin[a] > mx[a])
+                return false;
+            continue;
+        }
+        double t0 = (mn[a] - origin[a]) * invDir[a];
+        double t1 = (mx[a] - origin[a]) * invDir[a];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+        if (tEnter > tExit)
+            return false;
+    }
+    return true;
+}
+
+void ChunkQuadtree::update(const glm::ivec2 &chunk, int minY, int maxY) {
+    if (isEmpty(minY, maxY)) {
+        minY = INT_MAX;
+        maxY = INT_MIN;
+    }
+    levels_[0][chunk] = {minY, maxY, 1};
+    refreshAncestors(chunk);
+}
+
+void ChunkQuadtree::remove(const glm::ivec2 &chunk) {
+    if (levels_[0].erase(chunk))
+        refreshAncestors(chunk);
+}
+
+void ChunkQuadtree::clear() {
+    for (Level &level : levels_)
+        level.clear();
+}
+
+void ChunkQuadtree::refreshAncestors(const glm::ivec2 &chunk) {
+    for (int level = 1; level < LEVELS; ++level) {
+        const glm::ivec2 node = chunk >> level;
+        Node merged{INT_MAX, INT_MIN, 0};
+        for (int dz = 0; dz < 2; ++dz) {
+            for (int dx = 0; dx < 2; ++dx) {
+                const Level &children = levels_[level - 1];
+                auto it = children.find(node * 2 + glm::ivec2(dx, dz));
+                if (it == children.end())
+                    continue;
+                merged.minY = std::min(merged.minY, it->second.minY);
+                merged.maxY = std::max(merged.maxY, it->second.maxY);
+                merged.chunks += it->second.chunks;
+            }
+        }
+        if (merged.chunks == 0)
+            levels_[level].erase(node);
+        else
+            levels_[level][node] = merged;
+    }
+}
+
+void ChunkQuadtree::nodeBounds(int level, const glm::ivec2 &node,
+                               const Node &n, glm::dvec3 &mn,
+                               glm::dvec3 &mx) {
+    const glm::ivec2 first = node * (1 << level);
+    mn = glm::dvec3(chunkOrigin(first)) + glm::dvec3(0.0, n.minY, 0.0);
+    mx = mn + glm::dvec3(double(CHUNK_DIM.x) * (1 << level),
+                         double(n.maxY + 1 - n.minY),
+                         double(CHUNK_DIM.z) * (1 << level));
+}
+
+template <typename Accept>
+void ChunkQuadtree::visit(int level, const glm::ivec2 &node,
+                          const Accept &accept, int leafLevel,
+                          std::vector<glm::ivec2> &out) const {
+    auto it = levels_[level].find(node);
+    if (it == levels_[level].end() ||
+        isEmpty(it->second.minY, it->second.maxY) ||
+        !accept(level, node, it->second))
+        return;
+
+    if (level <= leafLevel) {
+        collectLeaves(level, node, out);
+        return;
+    }
+    for (int dz = 0; dz < 2; ++dz)
+        for (int dx = 0; dx < 2; ++dx)
+            visit(level - 1, node * 2 + glm::ivec2(dx, dz), accept,
+                  leafLevel, out);
+}
+
+void ChunkQuadtree::collectLeaves(int level, const glm::ivec2 &node,
+                                  std::vector<glm::ivec2> &out) const {
+    auto it = levels_[level].find(node);
+    if (it == levels_[level].end() ||
+        isEmpty(it->second.minY, it->second.maxY))
+        return;
+    if (level == 0) {
+        out.push_back(node);
+        return;
+    }
+    for (int dz = 0; dz < 2; ++dz)
+        for (int dx = 0; dx < 2; ++dx)
+            collectLeaves(level - 1, node * 2 + glm::ivec2(dx, dz), out);
+}
+
+void ChunkQuadtree::queryFrustum(const math::FrustumCuller &culler,
+                                 const CameraAnchor &anchor,
+                                 std::vector<glm::ivec2> &out,
+                                 int leafLevel) const {
+    auto accept = [&](int level, const glm::ivec2 &node, const Node &n) {
+        // Integer chunk delta first, as for any camera-relative box.
+        glm::vec3 mn = relativeOrigin(node * (1 << level), anchor);
+        mn.y += float(n.minY);
+        glm::vec3 mx = mn + glm::vec3(float(CHUNK_DIM.x << level),
+                                      float(n.maxY + 1 - n.minY),
+                                      float(CHUNK_DIM.z << level));
+        return culler.isBoxVisible(mn, mx);
+    };
+    leafLevel = std::clamp(leafLevel, 0, LEVELS - 1);
+    for (const auto &[root, n] : levels_[LEVELS - 1])
+        visit(LEVELS - 1, root, accept, leafLevel, out);
+}
+
+void ChunkQuadtree::querySphere(const WorldPos &center, double radius,
+                                std::vector<glm::ivec2> &out) const {
+    const double r2 = radius * radius;
+    auto accept = [&](int level, const glm::ivec2 &node, const Node &n) {
+        glm::dvec3 mn, mx;
+        nodeBounds(level, node, n, mn, mx);
+        glm::dvec3 d = center - glm::clamp(center, mn, mx);
+        return glm::dot(d, d) <= r2;
+    };
+    for (const auto &[root, n] : levels_[LEVELS - 1])
+        visit(LEVELS - 1, root, accept, 0, out);
+}
+
+void ChunkQuadtree::queryRay(const WorldPos &origin, const glm::dvec3 &dir,
+                             double maxDist, std::vector<RayHit> &out) const {
+    const glm::dvec3 invDir = glm::dvec3(1.0) / dir;
+    auto accept = [&](int level, const glm::ivec2 &node, const Node &n) {
+        glm::dvec3 mn, mx;
+        nodeBounds(level, node, n, mn, mx);
+        double tEnter, tExit;
+        return raySlab(origin, invDir, mn, mx, maxDist, tEnter, tExit);
+    };
+
+    std::vector<glm::ivec2> chunks;
+    for (const auto &[root, n] : levels_[LEVELS - 1])
+        visit(LEVELS - 1, root, accept, 0, chunks);
+
+    const size_t first = out.size();
+    for (const glm::ivec2 &chunk : chunks) {
+        glm::dvec3 mn, mx;
+        nodeBounds(0, chunk, levels_[0].at(chunk), mn, mx);
+        RayHit hit{chunk, 0.0, 0.0};
+        raySlab(origin, invDir, mn, mx, maxDist, hit.tEnter, hit.tExit);
+        out.push_back(hit);
+    }
+    std::sort(out.begin() + first, out.end(),
+              [](const RayHit &a, const RayHit &b) {
+                  return a.tEnter < b.tEnter;
+              });
+}
@@ -1,42 +1,172 @@
 #include "engine/world/ChunkRenderSystem.hpp"
 #include "engine/math/FrustumCulling.hpp"
-#include <glm/gtc/matrix_transform.hpp>
+#include "engine/world/Config.hpp"
+#include "engine/world/WorldCoords.hpp"
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <latch>
 #include <vulkan/vulkan.h>
 
 using namespace engine;
 using namespace engine::world;
 
-void ChunkRenderSystem::drawAll(RendererContext &ctx, const ChunkManager &mgr) {
-    VkCommandBuffer cmdBuf = ctx.getCurrentCommandBuffer();
-    VkPipelineLayout layout = ctx.getRenderResources().getPipeline().layout;
-
-    glm::mat4 vp = ctx.camera().viewProjection();
+void ChunkRenderSystem::collectChunks(RendererContext &ctx,
+                                      const ChunkManager &mgr,
+                                      std::vector<DrawItem> &out) {
+    // Cull in camera-relative space, matching what the shader draws.
     math::FrustumCuller culler;
-    culler.update(vp);
+    culler.update(ctx.camera().relativeViewProjection());
+    const CameraAnchor anchor = anchorOf(ctx.camera().getPosition());
 
-    for (const auto &[coord, chunk] : mgr.getChunks()) {
+    // The quadtree rejects off-screen regions down to 2x2 chunk nodes; the
+    // chunks under those are then batch-tested against their own bounds.
+    coords_.clear();
+    mgr.spatialIndex().queryFrustum(culler, anchor, coords_, 1);
+
+    bounds_.clear();
+    candidates_.clear();
+    const auto &chunks = mgr.getChunks();
+    for (const glm::ivec2 &coord : coords_) {
+        auto it = chunks.find(coord);
+        if (it == chunks.end())
+            continue;
+        const Chunk &chunk = it->second;
         if (!chunk.mesh || chunk.mesh->indexCount() == 0)
             continue;
 
-        glm::vec3 worldPos = glm::vec3(coord.x * 16, 0.0f, coord.y * 16);
-        glm::vec3 aabbMin = worldPos;
-        glm::vec3 aabbMax = worldPos + glm::vec3(chunk.volume->extent);
+        glm::vec3 rel = relativeOrigin(chunk.mesh->origin(), anchor);
+        bounds_.push({rel.x, rel.y + float(chunk.solidMinY), rel.z},
+                     {rel.x + CHUNK_DIM.x, rel.y + float(chunk.solidMaxY + 1),
+                      rel.z + CHUNK_DIM.z});
+        candidates_.push_back(chunk.mesh.get());
+    }
+    emitVisible(culler, out);
+}
+
+void ChunkRenderSystem::collectFarTiles(RendererContext &ctx,
+                                        const FarTerrain &terrain,
+                                        std::vector<DrawItem> &out) {
+    math::FrustumCuller culler;
+    culler.update(ctx.camera().relativeViewProjection());
+    const CameraAnchor anchor = anchorOf(ctx.camera().getPosition());
 
-        if (!culler.isBoxVisible(aabbMin, aabbMax))
+    const glm::ivec2 playerChunk = terrain.getPlayerChunk();
+    const glm::vec2 tileSize(FAR_TILE_CHUNKS * CHUNK_DIM.x,
+                             FAR_TILE_CHUNKS * CHUNK_DIM.z);
+
+    bounds_.clear();
+    candidates_.clear();
+    for (const auto &[coord, tile] : terrain.getTiles()) {
+        if (!tile.mesh || tile.mesh->indexCount() == 0)
+            continue;
+        if (FarTerrain::coveredByVoxels(coord, playerChunk))
             continue;
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), worldPos);
-        vkCmdPushConstants(cmdBuf, layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                           sizeof(glm::mat4), &model);
+        glm::vec3 rel = relativeOrigin(tile.mesh->origin(), anchor);
+        bounds_.push({rel.x, rel.y + tile.minY, rel.z},
+                     {rel.x + tileSize.x, rel.y + tile.maxY,
+                      rel.z + tileSize.y});
+        candidates_.push_back(tile.mesh.get());
+    }
+    emitVisible(culler, out);
+}
+
+void ChunkRenderSystem::emitVisible(const math::FrustumCuller &culler,
+                                    std::vector<DrawItem> &out) {
+    culler.cullBoxes(bounds_, visible_);
+    for (size_t w = 0; w < visible_.size(); ++w) {
+        for (uint64_t bits = visible_[w]; bits; bits &= bits - 1) {
+            const Mesh *mesh = candidates_[w * 64 + std::countr_zero(bits)];
+            out.push_back({mesh->vertexBuffer(), mesh->instanceOffset(),
+                           mesh->indexBuffer(),
+                           static_cast<uint32_t>(mesh->indexCount())});
+        }
+    }
+}
+
+void ChunkRenderSystem::record(VkCommandBuffer cmdBuf, const DrawItem *begin,
+                               const DrawItem *end) {
+    for (const DrawItem *d = begin; d != end; ++d) {
+        // Binding 1 reads the origin stored behind the vertices at upload.
+        VkBuffer vbos[] = {d->vertexBuffer, d->vertexBuffer};
+        VkDeviceSize offs[] = {0, d->instanceOffset};
+        vkCmdBindVertexBuffers(cmdBuf, 0, 2, vbos, offs);
+        vkCmdBindIndexBuffer(cmdBuf, d->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        vkCmdDrawIndexed(cmdBuf, d->indexCount, 1, 0, 0, 0);
+    }
+}
+
+void ChunkRenderSystem::drawAll(RendererContext &ctx, const ChunkManager &mgr) {
+    draws_.clear();
+    collectChunks(ctx, mgr, draws_);
+    record(ctx.getCurrentCommandBuffer(), draws_.data(),
+           draws_.data() + draws_.size());
+}
 
-        VkBuffer vbos[] = {chunk.mesh->vertexBuffer()};
-        VkDeviceSize offs[] = {0};
-        vkCmdBindVertexBuffers(cmdBuf, 0, 1, vbos, offs);
-        vkCmdBindIndexBuffer(cmdBuf, chunk.mesh->indexBuffer(), 0,
-                             VK_INDEX_TYPE_UINT32);
+void ChunkRenderSystem::drawFarTerrain(RendererContext &ctx,
+                                       const FarTerrain &terrain) {
+    draws_.clear();
+    collectFarTiles(ctx, terrain, draws_);
+    record(ctx.getCurrentCommandBuffer(), draws_.data(),
+           draws_.data() + draws_.size());
+}
 
-        vkCmdDrawIndexed(cmdBuf,
-                         static_cast<uint32_t>(chunk.mesh->indexCount()), 1, 0,
-                         0, 0);
+void ChunkRenderSystem::drawParallel(RendererContext &ctx,
+                                     const ChunkManager &mgr,
+                                     const FarTerrain &terrain,
+                                     utils::ThreadPool &pool) {
+    draws_.clear();
+    collectChunks(ctx, mgr, draws_);
+    collectFarTiles(ctx, terrain, draws_);
+
+    const size_t threads = ctx.recordThreadCount();
+    const size_t perThread = (draws_.size() + threads - 1) / threads;
+    const RenderResources &resources = ctx.getRenderResources();
+    const VkExtent2D extent = ctx.getSwapchain()->getExtent();
+
+    std::vector<VkCommandBuffer> secondaries(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::latch done(static_cast<std::ptrdiff_t>(threads));
+
+    for (size_t t = 0; t < threads; ++t) {
+        pool.enqueueJob([&, t]() {
+            try {
+                const size_t first = std::min(t * perThread, draws_.size());
+                const size_t last = std::min(first + perThread, draws_.size());
+
+                VkCommandBuffer cmd = ctx.beginSecondary(t);
+                // Dynamic state and bindings are not inherited.
+                resources.bindPipeline(cmd);
+                VkViewport viewport = {0.f,
+                                       0.f,
+                                       float(extent.width),
+                                       float(extent.height),
+                                       0.f,
+                                       1.f};
+                VkRect2D scissor = {{0, 0}, extent};
+                vkCmdSetViewport(cmd, 0, 1, &viewport);
+                vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+                record(cmd, draws_.data() + first, draws_.data() + last);
+                if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+                    throw std::runtime_error(
+                        "Failed to end secondary command buffer");
+                secondaries[t] = cmd;
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+            done.count_down();
+        });
     }
+    done.wait();
+
+    for (auto &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    vkCmdExecuteCommands(ctx.getCurrentCommandBuffer(),
+                         static_cast<uint32_t>(secondaries.size()),
+                         secondaries.data());
 }
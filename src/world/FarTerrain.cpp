@@ -0,0 +1,232 @@
+#include "engine/world/FarTerrain.hpp"
+#include "engine/render/GeometryScratch.hpp"
+#include "engine/render/Vertex.hpp"
+#include "engine/world/Config.hpp"
+#include "engine/world/TerrainGenerator.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace engine::world;
+
+static int stepForDistance(int tileDist) {
+    if (tileDist <= 3)
+        return 4;
+    if (tileDist <= 6)
+        return 8;
+    return 16;
+}
+
+static void emitQuad(std::vector<Vertex> &verts, std::vector<uint32_t> &idxs,
+                     const glm::vec3 &a, const glm::vec3 &b,
+                     const glm::vec3 &c, const glm::vec3 &d,
+                     const glm::vec3 &normal, const glm::vec3 &color) {
+    uint32_t base = uint32_t(verts.size());
+    // Keep the winding consistent with VoxelMesher: CCW around the normal.
+    if (glm::dot(glm::cross(b - a, c - a), normal) >= 0.0f) {
+        verts.push_back({a, normal, {0, 0}, color});
+        verts.push_back({b, normal, {0, 0}, color});
+        verts.push_back({c, normal, {0, 0}, color});
+        verts.push_back({d, normal, {0, 0}, color});
+    } else {
+        verts.push_back({a, normal, {0, 0}, color});
+        verts.push_back({d, normal, {0, 0}, color});
+        verts.push_back({c, normal, {0, 0}, color});
+        verts.push_back({b, normal, {0, 0}, color});
+    }
+    idxs.insert(idxs.end(),
+                {base, base + 1, base + 2, base, base + 2, base + 3});
+}
+
+bool FarTerrain::coveredByVoxels(const glm::ivec2 &tile,
+                                 const glm::ivec2 &playerChunk) {
+    glm::ivec2 lo = tile * FAR_TILE_CHUNKS;
+    glm::ivec2 hi = lo + glm::ivec2(FAR_TILE_CHUNKS - 1);
+    return lo.x >= playerChunk.x - VIEW_RADIUS &&
+           lo.y >= playerChunk.y - VIEW_RADIUS &&
+           hi.x <= playerChunk.x + VIEW_RADIUS &&
+           hi.y <= playerChunk.y + VIEW_RADIUS;
+}
+
+size_t FarTerrain::pendingBuilds() const {
+    size_t count = 0;
+    for (const auto &[coord, tile] : tiles_)
+        count += tile.jobQueued ? 1 : 0;
+    return count;
+}
+
+void FarTerrain::update(const WorldPos &playerPos,
+                        engine::utils::ThreadPool &threadPool,
+                        MeshRetireQueue &retired) {
+    playerChunk_ = chunkOf(playerPos);
+
+    {
+        std::lock_guard<std::mutex> lock(uploadedMtx_);
+        for (auto &b : uploaded_) {
+            FarTile &tile = tiles_[b.coord];
+            tile.coord = b.coord;
+            tile.step = b.step;
+            tile.minY = b.minY;
+            tile.maxY = b.maxY;
+            retired.retire(std::move(tile.mesh));
+            tile.mesh = std::move(b.mesh);
+            tile.jobQueued = false;
+        }
+        uploaded_.clear();
+    }
+
+    glm::ivec2 playerTile(int(floorDiv(playerChunk_.x, FAR_TILE_CHUNKS)),
+                          int(floorDiv(playerChunk_.y, FAR_TILE_CHUNKS)));
+
+    for (int dz = -FAR_TERRAIN_RADIUS; dz <= FAR_TERRAIN_RADIUS; ++dz) {
+        for (int dx = -FAR_TERRAIN_RADIUS; dx <= FAR_TERRAIN_RADIUS; ++dx) {
+            glm::ivec2 coord = playerTile + glm::ivec2(dx, dz);
+            if (coveredByVoxels(coord, playerChunk_))
+                continue;
+
+            FarTile &tile = tiles_[coord];
+            int step = stepForDistance(std::max(std::abs(dx), std::abs(dz)));
+            if (tile.jobQueued || tile.step == step)
+                continue;
+
+            tile.coord = coord;
+            tile.jobQueued = true;
+            threadPool.enqueueJob([this, coord, step]() {
+                FarTileBuild build{coord, step, 0.0f, 0.0f, nullptr};
+                build.mesh = buildTileMesh(coord, step, build.minY, build.maxY);
+                std::lock_guard<std::mutex> lock(builtMtx_);
+                built_.push_back(std::move(build));
+            });
+        }
+    }
+
+    // Drop tiles the player has left behind. One still being built stays
+    // until its upload lands, then goes on a later update.
+    for (auto it = tiles_.begin(); it != tiles_.end();) {
+        glm::ivec2 d = glm::abs(it->first - playerTile);
+        if (std::max(d.x, d.y) > FAR_TERRAIN_RADIUS && !it->second.jobQueued) {
+            retired.retire(std::move(it->second.mesh));
+            it = tiles_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<FarTileBuild> FarTerrain::collectBuilt() {
+    std::lock_guard<std::mutex> lock(builtMtx_);
+    std::vector<FarTileBuild> out = std::move(built_);
+    built_.clear();
+    return out;
+}
+
+void FarTerrain::installUploaded(FarTileBuild &&build) {
+    std::lock_guard<std::mutex> lock(uploadedMtx_);
+    uploaded_.push_back(std::move(build));
+}
+
+void FarTerrain::releaseMeshes() {
+    {
+        std::lock_guard<std::mutex> lock(uploadedMtx_);
+        uploaded_.clear();
+    }
+    for (auto &[coord, tile] : tiles_)
+        tile.mesh.reset();
+}
+
+std::unique_ptr<Mesh> FarTerrain::buildTileMesh(const glm::ivec2 &tile,
+                                                int step, float &minY,
+                                                float &maxY) {
+    const int sizeX = FAR_TILE_CHUNKS * CHUNK_DIM.x;
+    const int sizeZ = FAR_TILE_CHUNKS * CHUNK_DIM.z;
+    const int nx = sizeX / step;
+    const int nz = sizeZ / step;
+    const glm::ivec2 origin(tile.x * sizeX, tile.y * sizeZ);
+
+    // Heights carry a one-sample border so normals match across tiles.
+    const int sw = nx + 3;
+    std::vector<float> heights(size_t(sw) * size_t(nz + 3));
+    std::vector<glm::vec3> colors(size_t(nx + 1) * size_t(nz + 1));
+    auto h = [&](int i, int j) -> float & {
+        return heights[size_t(j + 1) * sw + size_t(i + 1)];
+    };
+
+    minY = float(CHUNK_DIM.y);
+    maxY = 0.0f;
+    for (int j = -1; j <= nz + 1; ++j) {
+        for (int i = -1; i <= nx + 1; ++i) {
+            ColumnHeights c = TerrainGenerator::SampleColumn(
+                float(origin.x + i * step), float(origin.y + j * step));
+            float top =
+                float(c.baseHeight + c.mountainHeight + 1 - FAR_TERRAIN_SINK);
+            h(i, j) = top;
+            if (i < 0 || j < 0 || i > nx || j > nz)
+                continue;
+
+            maxY = std::max(maxY, top);
+            minY = std::min(minY, top);
+            glm::vec3 color;
+            if (c.mountainHeight >= 20)
+                color = glm::vec3(0.95f);
+            else if (c.mountainHeight > 0)
+                color = glm::vec3(0.3f, 0.2f, 0.1f);
+            else
+                color = glm::vec3(0.2f, 0.6f, 0.2f);
+            colors[size_t(j) * (nx + 1) + i] = color;
+        }
+    }
+
+    GeometryScratch &scratch = threadGeometryScratch();
+    std::vector<Vertex> &verts = scratch.verts;
+    std::vector<uint32_t> &idxs = scratch.idxs;
+    verts.reserve(size_t(nx + 1) * (nz + 1) + size_t(nx + nz) * 8);
+    idxs.reserve(size_t(nx) * nz * 6 + size_t(nx + nz) * 12);
+
+    const float s = float(step);
+    for (int j = 0; j <= nz; ++j) {
+        for (int i = 0; i <= nx; ++i) {
+            glm::vec3 n = glm::normalize(glm::vec3(h(i - 1, j) - h(i + 1, j),
+                                                   2.0f * s,
+                                                   h(i, j - 1) - h(i, j + 1)));
+            verts.push_back({{i * s, h(i, j), j * s},
+                             n,
+                             {0, 0},
+                             colors[size_t(j) * (nx + 1) + i]});
+        }
+    }
+    for (int j = 0; j < nz; ++j) {
+        for (int i = 0; i < nx; ++i) {
+            uint32_t c00 = uint32_t(j * (nx + 1) + i);
+            uint32_t c10 = c00 + 1;
+            uint32_t c01 = c00 + uint32_t(nx + 1);
+            uint32_t c11 = c01 + 1;
+            idxs.insert(idxs.end(), {c00, c01, c11, c00, c11, c10});
+        }
+    }
+
+    // Skirts hang below every edge to hide cracks against neighbours
+    // sampled at a different step.
+    const float skirt = 4.0f * s;
+    auto edge = [&](int i0, int j0, int i1, int j1, const glm::vec3 &normal) {
+        glm::vec3 t0{i0 * s, h(i0, j0), j0 * s};
+        glm::vec3 t1{i1 * s, h(i1, j1), j1 * s};
+        float bottom = std::min(t0.y, t1.y) - skirt;
+        glm::vec3 b0{t0.x, bottom, t0.z};
+        glm::vec3 b1{t1.x, bottom, t1.z};
+        emitQuad(verts, idxs, b0, b1, t1, t0, normal,
+                 colors[size_t(j0) * (nx + 1) + i0]);
+        minY = std::min(minY, bottom);
+    };
+    for (int i = 0; i < nx; ++i) {
+        edge(i, 0, i + 1, 0, {0, 0, -1});
+        edge(i, nz, i + 1, nz, {0, 0, 1});
+    }
+    for (int j = 0; j < nz; ++j) {
+        edge(0, j, 0, j + 1, {-1, 0, 0});
+        edge(nx, j, nx, j + 1, {1, 0, 0});
+    }
+
+    auto mesh = std::make_unique<Mesh>();
+    mesh->setGeometry(verts, idxs);
+    mesh->setOrigin(tile * FAR_TILE_CHUNKS);
+    return mesh;
+}
@@ -0,0 +1,465 @@
+#include "engine/world/RegionStore.hpp"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define REGION_STORE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace engine::world;
+using engine::voxel::Voxel;
+using engine::voxel::VoxelVolume;
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'X', 'R', 'G'};
+constexpr size_t TABLE_ENTRY_SIZE = 16;
+// Encoded palette record: solid flag plus three float colour channels.
+constexpr size_t PALETTE_ENTRY_SIZE = 1 + 3 * sizeof(float);
+constexpr size_t HEADER_SIZE =
+    16 + TABLE_ENTRY_SIZE * RegionStore::REGION_SIZE * RegionStore::REGION_SIZE;
+// Rewrite a region once more than half of it (and at least 1 MiB) is dead.
+constexpr uint64_t COMPACT_MIN_GARBAGE = 1u << 20;
+
+int floorDiv(int a, int b) { return a / b - ((a % b != 0) && (a < 0)); }
+
+// put() and Reader::get() copy values in host order; the file format is
+// defined as little-endian, so a big-endian port must byte-swap in both.
+static_assert(std::endian::native == std::endian::little,
+              "RegionStore reads and writes little-endian hosts only");
+
+template <typename T> void put(std::vector<uint8_t> &out, const T &v) {
+    const auto *p = reinterpret_cast<const uint8_t *>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+void putVarint(std::vector<uint8_t> &out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+struct Reader {
+    const uint8_t *p;
+    const uint8_t *end;
+
+    template <typename T> bool get(T &v) {
+        if (size_t(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool varint(uint32_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (p == end)
+                return false;
+            uint8_t b = *p++;
+            v |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+};
+
+bool sameVoxel(const Voxel &a, const Voxel &b) {
+    return a.solid == b.solid && a.color == b.color;
+}
+
+struct VoxelKeyHash {
+    size_t operator()(const Voxel &v) const noexcept {
+        uint32_t bits[3];
+        std::memcpy(bits, &v.color, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+               (bits[2] * 83492791u) ^ size_t(v.solid);
+    }
+};
+
+struct VoxelKeyEq {
+    bool operator()(const Voxel &a, const Voxel &b) const noexcept {
+        return sameVoxel(a, b);
+    }
+};
+
+} // namespace
+
+struct RegionStore::Mapping {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+    Mapping() = default;
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+    ~Mapping() {
+#ifdef REGION_STORE_MMAP
+        if (data)
+            munmap(const_cast<uint8_t *>(data), size);
+#endif
+    }
+};
+
+RegionStore::RegionStore(std::string directory)
+    : directory_(std::move(directory)) {}
+
+glm::ivec2 RegionStore::regionOf(const glm::ivec2 &chunk) {
+    return {floorDiv(chunk.x, REGION_SIZE), floorDiv(chunk.y, REGION_SIZE)};
+}
+
+int RegionStore::slotOf(const glm::ivec2 &chunk) {
+    glm::ivec2 local = chunk - regionOf(chunk) * REGION_SIZE;
+    return local.y * REGION_SIZE + local.x;
+}
+
+std::string RegionStore::pathOf(const glm::ivec2 &region) const {
+    return directory_ + "/r." + std::to_string(region.x) + "." +
+           std::to_string(region.y) + ".region";
+}
+
+RegionStore::Region &RegionStore::openRegion(const glm::ivec2 &region) {
+    auto it = regions_.find(region);
+    if (it != regions_.end())
+        return it->second;
+
+    // Built aside and cached only once it checks out, so a bad file throws
+    // on every access instead of leaving a half-read region behind.
+    Region r;
+    std::ifstream in(pathOf(region), std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        return regions_[region];
+
+    r.fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0, std::ios::beg);
+    char magic[4];
+    uint32_t header[3];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header[0] != VERSION || header[1] != uint32_t(REGION_SIZE))
+        throw std::runtime_error("Corrupt region file: " + pathOf(region));
+
+    in.read(reinterpret_cast<char *>(r.table.data()),
+            TABLE_ENTRY_SIZE * r.table.size());
+    if (!in)
+        throw std::runtime_error("Truncated region file: " + pathOf(region));
+
+    uint64_t live = 0;
+    for (const Entry &e : r.table) {
+        if (e.size != 0 && (e.offset < HEADER_SIZE || e.offset > r.fileSize ||
+                            e.size > r.fileSize - e.offset))
+            throw std::runtime_error("Corrupt region table: " +
+                                     pathOf(region));
+        live += e.size;
+    }
+    if (live > r.fileSize - HEADER_SIZE)
+        throw std::runtime_error("Corrupt region table: " + pathOf(region));
+    r.garbage = r.fileSize - HEADER_SIZE - live;
+    return regions_.emplace(region, std::move(r)).first->second;
+}
+
+std::shared_ptr<const RegionStore::Mapping>
+RegionStore::mapEntry(const glm::ivec2 &region, Region &r, const Entry &e) {
+#ifdef REGION_STORE_MMAP
+    if (r.map && r.map->size >= e.offset + e.size)
+        return r.map;
+
+    int fd = ::open(pathOf(region).c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st {};
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && uint64_t(st.st_size) >= e.offset + e.size)
+        addr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return nullptr;
+
+    auto map = std::make_shared<Mapping>();
+    map->data = static_cast<const uint8_t *>(addr);
+    map->size = size_t(st.st_size);
+    r.map = map;
+    return map;
+#else
+    (void)region;
+    (void)r;
+    (void)e;
+    return nullptr;
+#endif
+}
+
+bool RegionStore::load(const glm::ivec2 &chunk, VoxelVolume &out) {
+    std::shared_ptr<const Mapping> map;
+    Entry e;
+    glm::ivec2 region = regionOf(chunk);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Region &r = openRegion(region);
+        e = r.table[slotOf(chunk)];
+        if (e.size == 0)
+            return false;
+        map = mapEntry(region, r, e);
+        if (!map) {
+            std::ifstream in(pathOf(region), std::ios::binary);
+            in.seekg(std::streamoff(e.offset));
+            std::vector<uint8_t> blob(e.size);
+            in.read(reinterpret_cast<char *>(blob.data()), e.size);
+            return in && decode(blob.data(), blob.size(), out);
+        }
+    }
+    // Decoding runs outside the lock, straight out of the page cache.
+    return decode(map->data + e.offset, e.size, out);
+}
+
+void RegionStore::prefetch(const glm::ivec2 &chunk) {
+#ifdef REGION_STORE_MMAP
+    std::shared_ptr<const Mapping> map;
+    Entry e;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        glm::ivec2 region = regionOf(chunk);
+        Region &r = openRegion(region);
+        e = r.table[slotOf(chunk)];
+        if (e.size == 0)
+            return;
+        map = mapEntry(region, r, e);
+        if (!map)
+            return;
+    }
+    const uintptr_t page = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = uintptr_t(map->data + e.offset) & ~(page - 1);
+    uintptr_t end = uintptr_t(map->data + e.offset + e.size);
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED);
+#else
+    (void)chunk;
+#endif
+}
+
+void RegionStore::save(const glm::ivec2 &chunk, const VoxelVolume &vol) {
+    saveBatch({{chunk, &vol}});
+}
+
+void RegionStore::saveBatch(
+    const std::vector<std::pair<glm::ivec2, const VoxelVolume *>> &chunks) {
+    // Encode outside the lock, then group blobs by region so each file gets
+    // a single append and a single table rewrite.
+    std::map<std::pair<int, int>, std::vector<std::pair<int, size_t>>> byRegion;
+    std::vector<std::vector<uint8_t>> blobs;
+    blobs.reserve(chunks.size());
+    for (const auto &[chunk, vol] : chunks) {
+        glm::ivec2 region = regionOf(chunk);
+        byRegion[{region.x, region.y}].push_back(
+            {slotOf(chunk), blobs.size()});
+        blobs.push_back(encode(*vol));
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (const auto &[key, slots] : byRegion) {
+        glm::ivec2 region{key.first, key.second};
+        Region &r = openRegion(region);
+        const std::string path = pathOf(region);
+
+        if (r.fileSize == 0) {
+            std::filesystem::create_directories(directory_);
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            uint32_t header[3] = {VERSION, uint32_t(REGION_SIZE), 0};
+            out.write(MAGIC, sizeof(MAGIC));
+            out.write(reinterpret_cast<const char *>(header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(r.table.data()),
+                      TABLE_ENTRY_SIZE * r.table.size());
+            if (!out)
+                throw std::runtime_error("Failed to create region file: " +
+                                         path);
+            r.fileSize = HEADER_SIZE;
+        }
+
+        std::vector<char> appended;
+        auto table = r.table;
+        uint64_t garbage = r.garbage;
+        for (const auto &[slot, blobIndex] : slots) {
+            const std::vector<uint8_t> &blob = blobs[blobIndex];
+            Entry &e = table[slot];
+            garbage += e.size;
+            e.offset = r.fileSize + appended.size();
+            e.size = uint32_t(blob.size());
+            appended.insert(appended.end(), blob.begin(), blob.end());
+        }
+
+        // Append first, then repoint the table, so a crash in between
+        // leaves the previous blobs reachable.
+        std::fstream io(path, std::ios::binary | std::ios::in | std::ios::out);
+        io.seekp(std::streamoff(r.fileSize));
+        io.write(appended.data(), std::streamsize(appended.size()));
+        io.flush();
+        io.seekp(16);
+        io.write(reinterpret_cast<const char *>(table.data()),
+                 TABLE_ENTRY_SIZE * table.size());
+        if (!io)
+            throw std::runtime_error("Failed to write region file: " + path);
+        io.close();
+
+        r.table = table;
+        r.garbage = garbage;
+        r.fileSize += appended.size();
+
+        if (r.garbage > COMPACT_MIN_GARBAGE &&
+            r.garbage * 2 > r.fileSize - HEADER_SIZE)
+            compactLocked(region, r);
+    }
+}
+
+void RegionStore::compact(const glm::ivec2 &region) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Region &r = openRegion(region);
+    if (r.fileSize != 0)
+        compactLocked(region, r);
+}
+
+void RegionStore::compactLocked(const glm::ivec2 &region, Region &r) {
+    const std::string path = pathOf(region);
+    const std::string tmpPath = path + ".tmp";
+
+    std::ifstream in(path, std::ios::binary);
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    std::array<Entry, REGION_SIZE * REGION_SIZE> table{};
+
+    out.seekp(std::streamoff(HEADER_SIZE));
+    uint64_t offset = HEADER_SIZE;
+    std::vector<char> buf;
+    for (size_t i = 0; i < r.table.size(); ++i) {
+        const Entry &e = r.table[i];
+        if (e.size == 0)
+            continue;
+        buf.resize(e.size);
+        in.seekg(std::streamoff(e.offset));
+        in.read(buf.data(), e.size);
+        out.write(buf.data(), e.size);
+        table[i] = {offset, e.size, 0};
+        offset += e.size;
+    }
+
+    uint32_t header[3] = {VERSION, uint32_t(REGION_SIZE), 0};
+    out.seekp(0);
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              TABLE_ENTRY_SIZE * table.size());
+    if (!in || !out)
+        throw std::runtime_error("Failed to compact region file: " + path);
+    in.close();
+    out.close();
+
+    std::filesystem::rename(tmpPath, path);
+    r.map.reset();
+    r.table = table;
+    r.fileSize = offset;
+    r.garbage = 0;
+}
+
+std::vector<uint8_t> RegionStore::encode(const VoxelVolume &vol) {
+    std::vector<Voxel> palette;
+    std::unordered_map<Voxel, uint32_t, VoxelKeyHash, VoxelKeyEq> lookup;
+    std::vector<std::pair<uint32_t, uint32_t>> runs;
+
+    // Runs are in logical x-fastest order whatever the in-memory layout,
+    // so region files stay readable across VOXEL_LAYOUT builds.
+    const glm::ivec3 e = vol.extent;
+    for (int z = 0; z < e.z; ++z) {
+        for (int y = 0; y < e.y; ++y) {
+            for (int x = 0; x < e.x; ++x) {
+                const Voxel &v = vol.atUnchecked(x, y, z);
+                // Colour is meaningless for air; fold all air into one entry.
+                Voxel key = v.solid ? v : Voxel{};
+                auto [it, inserted] =
+                    lookup.try_emplace(key, uint32_t(palette.size()));
+                if (inserted)
+                    palette.push_back(key);
+                if (!runs.empty() && runs.back().second == it->second)
+                    ++runs.back().first;
+                else
+                    runs.push_back({1, it->second});
+            }
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(16 + palette.size() * PALETTE_ENTRY_SIZE + runs.size() * 4);
+    put(out, int32_t(vol.extent.x));
+    put(out, int32_t(vol.extent.y));
+    put(out, int32_t(vol.extent.z));
+    put(out, uint32_t(palette.size()));
+    for (const Voxel &v : palette) {
+        put(out, uint8_t(v.solid));
+        put(out, v.color.x);
+        put(out, v.color.y);
+        put(out, v.color.z);
+    }
+    put(out, uint32_t(runs.size()));
+    for (const auto &[length, index] : runs) {
+        putVarint(out, length);
+        putVarint(out, index);
+    }
+    return out;
+}
+
+bool RegionStore::decode(const uint8_t *data, size_t size, VoxelVolume &out) {
+    Reader r{data, data + size};
+    int32_t ext[3];
+    uint32_t paletteCount;
+    if (!r.get(ext[0]) || !r.get(ext[1]) || !r.get(ext[2]) ||
+        !r.get(paletteCount))
+        return false;
+    if (glm::ivec3(ext[0], ext[1], ext[2]) != out.extent)
+        return false;
+
+    // Counts come from disk; bound them by what the blob can hold before
+    // allocating or writing anything.
+    if (paletteCount > size_t(r.end - r.p) / PALETTE_ENTRY_SIZE)
+        return false;
+    std::vector<Voxel> palette(paletteCount);
+    for (Voxel &v : palette) {
+        uint8_t solid;
+        if (!r.get(solid) || !r.get(v.color.x) || !r.get(v.color.y) ||
+            !r.get(v.color.z))
+            return false;
+        v.solid = solid != 0;
+    }
+
+    uint32_t runCount;
+    if (!r.get(runCount))
+        return false;
+
+    const glm::ivec3 e = out.extent;
+    size_t remaining = size_t(e.x) * size_t(e.y) * size_t(e.z);
+    int x = 0, y = 0, z = 0;
+    for (uint32_t i = 0; i < runCount; ++i) {
+        uint32_t length, index;
+        if (!r.varint(length) || !r.varint(index) || index >= paletteCount ||
+            length > remaining)
+            return false;
+        remaining -= length;
+        const Voxel &v = palette[index];
+        for (uint32_t k = 0; k < length; ++k) {
+            out.setUnchecked(x, y, z, v);
+            if (++x == e.x) {
+                x = 0;
+                if (++y == e.y) {
+                    y = 0;
+                    ++z;
+                }
+            }
+        }
+    }
+    return z == e.z;
+}
@@ -1,117 +1,159 @@
 #include "engine/world/TerrainGenerator.hpp"
 #include <externals/FastNoiseLite.h>
 #include <glm/glm.hpp>
-#include <random>
+#include <cstdint>
+#include <vector>
 
 namespace engine::world {
 
-void TerrainGenerator::Generate(engine::voxel::VoxelVolume &vol,
-                                const glm::ivec3 &chunkCoord) {
-    static FastNoiseLite baseNoise;
-    static FastNoiseLite mountainNoise;
-    baseNoise.SetSeed(1337);
-    baseNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+static constexpr int stoneLayer = 4;
+static constexpr int dirtLayer = 3;
+static constexpr int grassLayer = 1;
+
+static const FastNoiseLite &baseNoise() {
+    static const FastNoiseLite noise = [] {
+        FastNoiseLite n;
+        n.SetSeed(1337);
+        n.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+        return n;
+    }();
+    return noise;
+}
 
-    mountainNoise.SetSeed(42);
-    mountainNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-    mountainNoise.SetFrequency(0.01f);
+static const FastNoiseLite &mountainNoise() {
+    static const FastNoiseLite noise = [] {
+        FastNoiseLite n;
+        n.SetSeed(42);
+        n.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+        n.SetFrequency(0.01f);
+        return n;
+    }();
+    return noise;
+}
 
+ColumnHeights TerrainGenerator::SampleColumn(float wx, float wz) {
+    float n = baseNoise().GetNoise(wx * 0.05f, wz * 0.05f);
+    n = glm::clamp(n, -1.0f, 1.0f);
+    int baseHeight = stoneLayer + dirtLayer + grassLayer + int(n * 6.0f);
+
+    float m = mountainNoise().GetNoise(wx, wz);
+    m = glm::clamp(m, 0.0f, 1.0f);
+    int mountainHeight = int(m * 32.0f);
+
+    return {baseHeight, mountainHeight};
+}
+
+/// Integer hash of a world-space cell; stands in for a sequential RNG so a
+/// voxel's colour does not depend on the order cells are visited in.
+static uint32_t hashCell(int x, int y, int z) {
+    uint32_t h = uint32_t(x) * 73856093u ^ uint32_t(y) * 19349663u ^
+                 uint32_t(z) * 83492791u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/// Uniform in [-0.1, 0.1) for colour channel `c` of a world cell.
+static float variation(int wx, int wy, int wz, int c) {
+    return float(hashCell(wx, wy * 4 + c, wz) >> 8) * (0.2f / 16777216.0f) -
+           0.1f;
+}
+
+template <typename Layout>
+void TerrainGenerator::Generate(engine::voxel::BasicVoxelVolume<Layout> &vol,
+                                const glm::ivec3 &chunkCoord) {
     const glm::ivec3 ext = vol.extent;
-    const int stoneLayer = 4;
-    const int dirtLayer = 3;
-    const int grassLayer = 1;
 
-    std::mt19937 rng(chunkCoord.x * 73856093 ^ chunkCoord.z * 19349663);
-    std::uniform_real_distribution<float> variation(-0.1f, 0.1f);
-    std::bernoulli_distribution treeDist(0.02f);
     const int minTrunkHeight = 4;
     const int maxTrunkHeight = 6;
     const int canopyRadius = 2;
+    const uint32_t treeChance = uint32_t(0.02 * 65536.0);
 
+    // Heights first, so the fill below can walk the volume in its own
+    // storage order instead of column by column.
+    std::vector<ColumnHeights> heights(size_t(ext.x) * ext.z);
+    for (int z = 0; z < ext.z; ++z)
+        for (int x = 0; x < ext.x; ++x)
+            heights[z * ext.x + x] =
+                SampleColumn(float(chunkCoord.x + x), float(chunkCoord.z + z));
+
+    engine::voxel::forEachInLayoutOrder<Layout>(ext, [&](int x, int y,
+                                                         int z) {
+        const ColumnHeights &column = heights[z * ext.x + x];
+        const int baseHeight = column.baseHeight;
+        const int mountainHeight = column.mountainHeight;
+        const int wx = chunkCoord.x + x, wz = chunkCoord.z + z;
+        const int worldY = chunkCoord.y + y;
+        auto vary = [&](int c) { return variation(wx, worldY, wz, c); };
+
+        engine::voxel::Voxel voxel;
+        if (worldY <= baseHeight - (dirtLayer + grassLayer)) {
+            voxel.solid = true;
+            voxel.color = glm::vec3(0.4f + vary(0)); // stone
+        } else if (worldY <= baseHeight - grassLayer) {
+            voxel.solid = true;
+            voxel.color = glm::vec3(0.4f + vary(0), 0.25f + vary(1),
+                                    0.1f + vary(2)); // dirt
+        } else if (worldY <= baseHeight) {
+            voxel.solid = true;
+            voxel.color =
+                glm::vec3(0.2f + vary(0), 0.6f + vary(1), 0.2f + vary(2));
+        } else if (worldY <= baseHeight + mountainHeight) {
+            voxel.solid = true;
+            int localH = worldY - baseHeight;
+            if (mountainHeight >= 20 && localH >= (mountainHeight - 2)) {
+                voxel.color = glm::vec3(0.95f);
+            } else {
+                voxel.color = glm::vec3(0.3f + vary(0), 0.2f + vary(1),
+                                        0.1f + vary(2));
+            }
+        } else {
+            voxel.solid = false;
+        }
+        vol.setUnchecked(x, y, z, voxel);
+    });
+
+    // Trees go in after the fill so no column can overwrite a neighbour's
+    // canopy.
     for (int z = 0; z < ext.z; ++z) {
         for (int x = 0; x < ext.x; ++x) {
-            float wx = float(chunkCoord.x + x);
-            float wz = float(chunkCoord.z + z);
-
-            float n = baseNoise.GetNoise(wx * 0.05f, wz * 0.05f);
-            n = glm::clamp(n, -1.0f, 1.0f);
-            int baseHeight =
-                stoneLayer + dirtLayer + grassLayer + int(n * 6.0f);
-
-            float m = mountainNoise.GetNoise(wx, wz);
-            m = glm::clamp(m, 0.0f, 1.0f);
-            int mountainHeight = int(m * 32.0f);
-            int mountainTopWorldY = baseHeight + mountainHeight;
-
-            // 3) Fill column
-            for (int y = 0; y < ext.y; ++y) {
-                auto &voxel = vol.at(x, y, z);
-                int worldY = chunkCoord.y + y;
-
-                if (worldY <= baseHeight - (dirtLayer + grassLayer)) {
-                    voxel.solid = true;
-                    float v = 0.4f + variation(rng);
-                    voxel.color = glm::vec3(v); // stone
-                } else if (worldY <= baseHeight - grassLayer) {
-                    voxel.solid = true;
-                    voxel.color =
-                        glm::vec3(0.4f + variation(rng), 0.25f + variation(rng),
-                                  0.1f + variation(rng)); // dirt
-                } else if (worldY <= baseHeight) {
-                    voxel.solid = true;
-                    voxel.color =
-                        glm::vec3(0.2f + variation(rng), 0.6f + variation(rng),
-                                  0.2f + variation(rng));
-                } else if (worldY <= mountainTopWorldY) {
-                    voxel.solid = true;
-                    int localH = worldY - baseHeight;
-                    if (mountainHeight >= 20 &&
-                        localH >= (mountainHeight - 2)) {
-                        voxel.color = glm::vec3(0.95f);
-                    } else {
-                        voxel.color = glm::vec3(0.3f + variation(rng),
-                                                0.2f + variation(rng),
-                                                0.1f + variation(rng));
-                    }
-                } else {
-                    voxel.solid = false;
-                }
-            }
+            const ColumnHeights &column = heights[z * ext.x + x];
+            const uint32_t h =
+                hashCell(chunkCoord.x + x, 0x7ee, chunkCoord.z + z);
+            if (column.mountainHeight != 0 || (h & 0xffff) >= treeChance)
+                continue;
 
-            if (mountainHeight == 0 && treeDist(rng)) {
-                int trunkBaseY = (baseHeight - chunkCoord.y) + 1;
-                int trunkH = minTrunkHeight +
-                             (rng() % (maxTrunkHeight - minTrunkHeight + 1));
-
-                for (int i = 0; i < trunkH; ++i) {
-                    int yy = trunkBaseY + i;
-                    if (yy < 0 || yy >= ext.y)
-                        break;
-                    auto &logV = vol.at(x, yy, z);
-                    logV.solid = true;
-                    logV.color = glm::vec3(0.55f, 0.27f, 0.07f); // wood
-                }
+            int trunkBaseY = (column.baseHeight - chunkCoord.y) + 1;
+            int trunkH = minTrunkHeight +
+                         int((h >> 16) % (maxTrunkHeight - minTrunkHeight + 1));
+
+            for (int i = 0; i < trunkH; ++i) {
+                int yy = trunkBaseY + i;
+                if (yy < 0 || yy >= ext.y)
+                    break;
+                const glm::vec3 wood(0.55f, 0.27f, 0.07f);
+                vol.setUnchecked(x, yy, z, {true, wood});
+            }
 
-                int leafStartY = trunkBaseY + trunkH - 1;
-                for (int ly = leafStartY; ly <= leafStartY + 2; ++ly) {
-                    if (ly < 0 || ly >= ext.y)
+            int leafStartY = trunkBaseY + trunkH - 1;
+            for (int ly = leafStartY; ly <= leafStartY + 2; ++ly) {
+                if (ly < 0 || ly >= ext.y)
+                    continue;
+                for (int lx = x - canopyRadius; lx <= x + canopyRadius; ++lx) {
+                    if (lx < 0 || lx >= ext.x)
                         continue;
-                    for (int lx = x - canopyRadius; lx <= x + canopyRadius;
-                         ++lx) {
-                        if (lx < 0 || lx >= ext.x)
+                    for (int lz = z - canopyRadius; lz <= z + canopyRadius;
+                         ++lz) {
+                        if (lz < 0 || lz >= ext.z)
+                            continue;
+                        if (ly == leafStartY && abs(lx - x) == canopyRadius &&
+                            abs(lz - z) == canopyRadius)
                             continue;
-                        for (int lz = z - canopyRadius; lz <= z + canopyRadius;
-                             ++lz) {
-                            if (lz < 0 || lz >= ext.z)
-                                continue;
-                            if (ly == leafStartY &&
-                                abs(lx - x) == canopyRadius &&
-                                abs(lz - z) == canopyRadius)
-                                continue;
-                            auto &leafV = vol.at(lx, ly, lz);
-                            leafV.solid = true;
-                            leafV.color = glm::vec3(0.0f, 0.8f, 0.0f); // leaves
-                        }
+                        const glm::vec3 leaves(0.0f, 0.8f, 0.0f);
+                        vol.setUnchecked(lx, ly, lz, {true, leaves});
                     }
                 }
             }
@@ -119,4 +161,14 @@ void TerrainGenerator::Generate(engine::voxel::VoxelVolume &vol,
     }
 }
 
+template void TerrainGenerator::Generate(
+    engine::voxel::BasicVoxelVolume<engine::voxel::LinearLayout> &,
+    const glm::ivec3 &);
+template void TerrainGenerator::Generate(
+    engine::voxel::BasicVoxelVolume<engine::voxel::Brick4Layout> &,
+    const glm::ivec3 &);
+template void TerrainGenerator::Generate(
+    engine::voxel::BasicVoxelVolume<engine::voxel::MortonLayout> &,
+    const glm::ivec3 &);
+
 } // namespace engine::world
@@ -0,0 +1,212 @@
+#include "engine/world/VoxelRaycaster.hpp"
+#include "engine/world/Config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace engine::world;
+
+// Rays per pool job; small enough to balance, large enough to amortise.
+static constexpr size_t RAYS_PER_JOB = 256;
+
+std::optional<VoxelHit> VoxelRaycaster::Trace(const ChunkManager &chunks,
+                                              const Ray &ray) {
+    const bool finite = std::isfinite(ray.maxDist) &&
+                        std::isfinite(ray.origin.x) &&
+                        std::isfinite(ray.origin.y) &&
+                        std::isfinite(ray.origin.z) &&
+                        std::isfinite(ray.dir.x) && std::isfinite(ray.dir.y) &&
+                        std::isfinite(ray.dir.z);
+    if (!finite)
+        throw std::invalid_argument("VoxelRaycaster::Trace: non-finite ray");
+    const double len = glm::length(ray.dir);
+    if (!(len > 0.0))
+        return std::nullopt;
+    const glm::dvec3 dir = ray.dir / len;
+    constexpr double inf = std::numeric_limits<double>::infinity();
+
+    // Per-axis step, distance between crossings, and distance to the first.
+    VoxelCoord voxel(glm::floor(ray.origin));
+    glm::i64vec3 step(0);
+    glm::dvec3 tDelta(inf), tMax(inf);
+    for (int a = 0; a < 3; ++a) {
+        if (dir[a] > 0.0) {
+            step[a] = 1;
+            tDelta[a] = 1.0 / dir[a];
+            tMax[a] = (double(voxel[a] + 1) - ray.origin[a]) * tDelta[a];
+        } else if (dir[a] < 0.0) {
+            step[a] = -1;
+            tDelta[a] = -1.0 / dir[a];
+            tMax[a] = (ray.origin[a] - double(voxel[a])) * tDelta[a];
+        }
+    }
+
+    glm::ivec2 coord;
+    VoxelCoord base;
+    const Chunk *chunk = nullptr;
+    auto enterChunk = [&] {
+        coord = chunkOf(voxel);
+        base = chunkOrigin(coord);
+        auto it = chunks.getChunks().find(coord);
+        chunk = it == chunks.getChunks().end() || !it->second.volume
+                    ? nullptr
+                    : &it->second;
+    };
+    enterChunk();
+
+    glm::ivec3 normal(0);
+    double t = 0.0;
+
+    // Moves the walk to the first voxel past the box [lo, hi], which holds
+    // no solid voxel. False if the ray does not leave it within maxDist.
+    auto skipBox = [&](const VoxelCoord &lo, const VoxelCoord &hi) {
+        int exit = -1;
+        double tLeave = inf;
+        for (int a = 0; a < 3; ++a) {
+            if (step[a] == 0)
+                continue;
+            const int64_t left = step[a] > 0 ? hi[a] - voxel[a]
+                                             : voxel[a] - lo[a];
+            const double ta = tMax[a] + double(left) * tDelta[a];
+            if (ta < tLeave) {
+                tLeave = ta;
+                exit = a;
+            }
+        }
+        if (exit < 0 || tLeave > ray.maxDist)
+            return false;
+
+        // Catch the other axes up with every crossing before tLeave.
+        for (int a = 0; a < 3; ++a) {
+            if (a == exit || step[a] == 0 || !(tMax[a] < tLeave))
+                continue;
+            const int64_t n =
+                int64_t(std::ceil((tLeave - tMax[a]) / tDelta[a]));
+            voxel[a] += step[a] * n;
+            tMax[a] += double(n) * tDelta[a];
+            while (tMax[a] < tLeave) {
+                voxel[a] += step[a];
+                tMax[a] += tDelta[a];
+            }
+        }
+        voxel[exit] = step[exit] > 0 ? hi[exit] + 1 : lo[exit] - 1;
+        tMax[exit] = tLeave + tDelta[exit];
+        t = tLeave;
+        normal = glm::ivec3(0);
+        normal[exit] = -int(step[exit]);
+        return true;
+    };
+
+    auto stepOne = [&] {
+        int a = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2)
+                                : (tMax.y < tMax.z ? 1 : 2);
+        t = tMax[a];
+        voxel[a] += step[a];
+        tMax[a] += tDelta[a];
+        normal = glm::ivec3(0);
+        normal[a] = -int(step[a]);
+    };
+
+    // Stands in for an unbounded height range in skipBox.
+    constexpr int64_t FAR_Y = int64_t(1) << 40;
+    while (t <= ray.maxDist) {
+        const int64_t y = voxel.y;
+        if ((y < 0 && step.y <= 0) || (y >= CHUNK_DIM.y && step.y >= 0))
+            break; // left the world vertically for good
+
+        if (voxel.x < base.x || voxel.x >= base.x + CHUNK_DIM.x ||
+            voxel.z < base.z || voxel.z >= base.z + CHUNK_DIM.z)
+            enterChunk();
+
+        // Height range around y known to hold no solid voxel: all of it in
+        // a missing chunk, else what lies outside the solid range, else an
+        // all-air section.
+        int64_t y0 = -FAR_Y, y1 = FAR_Y;
+        if (chunk && y < chunk->solidMinY) {
+            y1 = chunk->solidMinY - 1;
+        } else if (chunk && y > chunk->solidMaxY) {
+            y0 = chunk->solidMaxY + 1;
+        } else if (chunk) {
+            const auto &vol = *chunk->volume;
+            const int s = vol.sectionOf(int(y));
+            if (!vol.sectionAllAir(s)) {
+                const int lx = int(voxel.x - base.x), ly = int(y),
+                          lz = int(voxel.z - base.z);
+                if (vol.isSolid(lx, ly, lz))
+                    return VoxelHit{voxel, normal, t,
+                                    vol.atUnchecked(lx, ly, lz)};
+                stepOne();
+                continue;
+            }
+            y0 = int64_t(s) * vol.SECTION_HEIGHT;
+            y1 = std::min<int64_t>(y0 + vol.SECTION_HEIGHT, CHUNK_DIM.y) - 1;
+        }
+
+        const VoxelCoord lo(base.x, y0, base.z);
+        const VoxelCoord hi(base.x + CHUNK_DIM.x - 1, y1,
+                            base.z + CHUNK_DIM.z - 1);
+        if (!skipBox(lo, hi))
+            break;
+    }
+    return std::nullopt;
+}
+
+void VoxelRaycaster::TraceBatch(const ChunkManager &chunks,
+                                const std::vector<Ray> &rays,
+                                std::vector<std::optional<VoxelHit>> &hits,
+                                engine::utils::ThreadPool &pool) {
+    hits.assign(rays.size(), std::nullopt);
+    const size_t jobs = (rays.size() + RAYS_PER_JOB - 1) / RAYS_PER_JOB;
+    if (jobs == 0)
+        return;
+
+    // Shared with the helpers, which may only start after we return.
+    struct Batch {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<std::exception_ptr> errors;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->errors.resize(jobs);
+
+    // Claims jobs until none are left. A helper that starts late claims
+    // nothing, so it never touches the caller's rays or hits.
+    auto work = [batch, jobs, &chunks, &rays, &hits] {
+        for (size_t j; (j = batch->next.fetch_add(1)) < jobs;) {
+            try {
+                const size_t first = j * RAYS_PER_JOB;
+                const size_t last = std::min(first + RAYS_PER_JOB, rays.size());
+                for (size_t i = first; i < last; ++i)
+                    hits[i] = Trace(chunks, rays[i]);
+            } catch (...) {
+                batch->errors[j] = std::current_exception();
+            }
+            if (batch->finished.fetch_add(1) + 1 == jobs) {
+                std::lock_guard<std::mutex> lock(batch->mtx);
+                batch->cv.notify_all();
+            }
+        }
+    };
+    const size_t helpers =
+        std::min<size_t>(jobs - 1, std::thread::hardware_concurrency());
+    for (size_t h = 0; h < helpers; ++h)
+        pool.enqueueJob(work);
+    work();
+    {
+        std::unique_lock<std::mutex> lock(batch->mtx);
+        batch->cv.wait(lock, [&] { return batch->finished == jobs; });
+    }
+
+    for (auto &error : batch->errors)
+        if (error)
+            std::rethrow_exception(error);
+}